@@ -7,10 +7,13 @@
 #include "flecsi/execution.hh"
 #include "flecsi/topo/size.hh"
 #include "flecsi/util/array_ref.hh"
+#include "flecsi/util/mpi.hh"
 #include <flecsi/data/field.hh>
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <stack>
 
@@ -720,12 +723,19 @@ public:
   }
 
   void commit() const {
-    // To move each element before overwriting it, we propagate moves outward
-    // from each place where the movement switches from rightward to leftward.
-    const auto all = acc.get_base().span();
     const size_type n = size();
     if(!n) // code below caches the current row
       return;
+    if constexpr(std::is_trivially_copyable_v<T>)
+      if(std::none_of(over->begin(), over->end(), [](const Overflow & o) {
+           return o.del;
+         })) {
+        append();
+        return;
+      }
+    // To move each element before overwriting it, we propagate moves outward
+    // from each place where the movement switches from rightward to leftward.
+    const auto all = acc.get_base().span();
     // Read and write cursors.  It would be possible, if ugly, to run cursors
     // backwards for the rightward-moving portions and do without the stack.
     size_type is = 0, id = 0;
@@ -789,6 +799,35 @@ public:
   }
 
 private:
+  // Commit when no row has lost elements, so that every row moves rightward
+  // by the number of elements added to the rows before it.  Working from the
+  // back, each row is moved once (without overlapping any row not yet
+  // moved) and followed by its additions.
+  void append() const {
+    const auto all = acc.get_base().span();
+    auto & off = acc.get_offsets();
+    base_size delta = 0;
+    for(auto & ov : *over)
+      delta += ov.add.size();
+    flog_assert(acc.total() + delta <= all.size(),
+      "ragged entries overrun allocation for " << all.size() << " entries");
+    for(size_type i = size(); delta && i--;) {
+      auto & ov = (*over)[i];
+      const auto s = get_base()[i];
+      const auto na = ov.add.size();
+      delta -= na;
+      T * const w = s.data() + delta;
+      if(delta)
+        std::memmove(static_cast<void *>(w), s.data(), s.size() * sizeof(T));
+      if(na)
+        std::memcpy(
+          static_cast<void *>(w + s.size()), ov.add.data(), na * sizeof(T));
+      off(i) += delta + na;
+      ov.add.clear();
+    }
+    sz = grow(acc.total(), all.size());
+  }
+
   raw_row raw_get(size_type i) const {
     return {get_base()[i], &(*over)[i]};
   }
@@ -976,10 +1015,29 @@ public:
       return {i, !hit};
     }
     // TODO: insert(U&&), insert(value_type&&)
+    /// Insert elements whose keys are not already present.
+    /// The row is merged with the new elements all at once, so this is
+    /// much faster than separate insertions of many elements.
     template<class I>
     void insert(I a, I b) const {
-      for(; a != b; ++a)
-        insert(*a);
+      std::vector<value_type> t(a, b);
+      std::stable_sort(t.begin(), t.end(), less);
+      // Keep the first of each key, and none that are already present.
+      t.erase(std::unique(t.begin(),
+                t.end(),
+                [](const value_type & x, const value_type & y) {
+                  return x.first == y.first;
+                }),
+        t.end());
+      t.erase(std::remove_if(t.begin(),
+                t.end(),
+                [this](const value_type & v) {
+                  return lookup(v.first).second;
+                }),
+        t.end());
+      for(auto & v : t)
+        r.push_back(v);
+      merge(t);
     }
     void insert(std::initializer_list<value_type> l) const {
       insert(l.begin(), l.end());
@@ -1041,6 +1099,10 @@ public:
     /// \}
 
   private:
+    static bool less(const value_type & x, const value_type & y) {
+      return x.first < y.first;
+    }
+
     base_iterator lower(key_type c) const {
       return std::partition_point(
         r.begin(), r.end(), [c](const value_type & v) { return v.first < c; });
@@ -1050,6 +1112,18 @@ public:
       return {i, i != r.end() && i->first == c};
     }
 
+    // Merge sorted elements with new keys into the row, whose last t.size()
+    // elements are overwritten.  Working from the back, each element moves
+    // at most once.
+    void merge(std::vector<value_type> & t) const {
+      for(auto i = r.end() - t.size(), w = r.end(), b = r.begin(); !t.empty();
+          t.pop_back()) {
+        for(const auto k = t.back().first; i != b && k < (*(i - 1)).first;)
+          *--w = std::move(*--i);
+        *--w = std::move(t.back());
+      }
+    }
+
     // We simply keep the (ragged) row sorted; this avoids the complexity of
     // two lookaside structures and is efficient for small numbers of inserted
     // elements and for in-order initialization.
@@ -1260,9 +1334,10 @@ struct mutator<particle, T, P> : particle_accessor<T, P, true> {
   using typename base_type::iterator;
   using typename base_type::value_type;
   using Skip = typename base_type::base_type::value_type::size_type;
+  using typename base_type::size_type;
 
-  // We don't support automatic resizing since we don't control the region.
-  // TODO: Support manual resizing (by updating the skipfield appropriately)
+  // We don't support automatic resizing since we don't control the region;
+  // see resize_particles.
   using base_type::base_type;
 
   // Since, by design, the skipfield data structure requires no lookaside
@@ -1352,6 +1427,26 @@ struct mutator<particle, T, P> : particle_accessor<T, P, true> {
     return iterator(this, 1 + (i ? i + beg : this->first_skip()));
   }
 
+  /// Move all particles to the front, preserving their order, so that
+  /// iteration visits consecutive slots.  Invalidates all iterators.
+  /// \return the previous location of the particle now at each location,
+  ///   for permuting other fields
+  std::vector<size_type> compact() const {
+    std::vector<size_type> ret;
+    ret.reserve(this->size());
+    for(auto i = this->begin(), e = this->end(); i != e; ++i)
+      ret.push_back(i.location());
+    const auto s = this->span();
+    // Each particle moves leftward, into a slot already vacated:
+    for(size_type j = 0; j < ret.size(); ++j)
+      if(const auto i = ret[j]; i != j) {
+        new(&s[j].data) T(std::move(s[i].data));
+        s[i].reset();
+      }
+    relink(ret.size());
+    return ret;
+  }
+
   void commit() const {}
 
   template<class F>
@@ -1361,7 +1456,29 @@ struct mutator<particle, T, P> : particle_accessor<T, P, true> {
       init(); // no-op on caller side
   }
 
+  // Incorporate slots added after compact(); for resize_particles.
+  void extend() const {
+    const auto s = this->span();
+    relink(s.empty() ? 0 : s.front().skip);
+  }
+
 private:
+  // Mark the first n slots as used and the rest as free.
+  void relink(size_type n) const {
+    if(!n)
+      return init();
+    const auto s = this->span();
+    const size_type c = s.size();
+    s.front().skip = n; // head of free list
+    for(size_type i = 1; i < n; ++i)
+      s[i].skip = 0;
+    if(n < c) {
+      auto & h = s[n];
+      h.skip = s[c - 1].skip = c - n;
+      h.free = {n, c};
+    }
+  }
+
   FLECSI_INLINE_TARGET void init() const {
     const auto s = this->span();
     if(const auto n = s.size()) {
@@ -1377,6 +1494,158 @@ private:
   }
 };
 
+namespace detail {
+template<class T>
+void
+size_particles(accessor<data::particle, T, privilege_pack<ro>> a,
+  topo::resize::Field::accessor<rw> sz,
+  topo::resize::policy grow,
+  bool first) {
+  const auto n = grow(a.size(), a.capacity());
+  sz = first ? n : std::max(sz.get(), n);
+}
+template<class T>
+void
+compact_particles(mutator<data::particle, T, privilege_pack<rw>> m) {
+  m.compact();
+}
+template<class T>
+void
+extend_particles(mutator<data::particle, T, privilege_pack<rw>> m) {
+  m.extend();
+}
+
+// Apply new sizes to the partition of particle fields.
+template<class P, class... RR>
+void
+reallocate_particles(P & p, const RR &... rr) {
+  (execute<compact_particles<typename RR::value_type>>(rr), ...);
+  p.resize();
+  (execute<extend_particles<typename RR::value_type>>(rr), ...);
+}
+
+// Count the particles that will be present after migration and choose a new
+// size if they won't fit.
+template<class F, class T>
+int
+count_migrants(const F & dest,
+  accessor<data::particle, T, privilege_pack<ro>> a,
+  topo::resize::Field::accessor<wo> sz,
+  topo::resize::policy grow) {
+  const Color me = color();
+  std::map<Color, std::size_t> out;
+  std::size_t n = a.size();
+  for(auto & p : a)
+    if(const Color d = dest(p); d != me) {
+      flog_assert(d < processes(), "invalid destination color " << d);
+      ++out[d];
+      --n;
+    }
+  for(auto & [s, k] : util::mpi::sparse_all_to_allv(out))
+    n += k;
+  const auto cap = a.capacity();
+  const bool ret = n > cap;
+  sz = ret ? grow(n, cap) : cap;
+  return ret;
+}
+
+// Move the particles whose destination (according to the first field) is
+// another color, taking the element at the same location from each field.
+template<class F, class... TT>
+void
+migrate_particles(const F & dest,
+  mutator<data::particle, TT, privilege_pack<rw>>... mm) {
+  using batch = std::tuple<std::vector<TT>...>;
+  const Color me = color();
+  const auto & m = std::get<0>(std::tie(mm...));
+  std::map<Color, batch> out;
+  for(auto i = m.begin(), e = m.end(); i != e;) {
+    const Color d = dest(*i);
+    if(d == me) {
+      ++i;
+      continue;
+    }
+    // Erasing a particle does not invalidate iterators to others:
+    const auto l = i++.location();
+    const auto take = [l](auto & v, const auto & f) {
+      const typename std::remove_reference_t<decltype(f)>::iterator j(&f, l);
+      v.push_back(std::move(*j));
+      f.erase(j);
+    };
+    std::apply([&](auto &... vv) { (take(vv, mm), ...); }, out[d]);
+  }
+  for(auto & [s, b] : util::mpi::sparse_all_to_allv(out))
+    std::apply(
+      [&](auto &... vv) {
+        const auto n = std::get<0>(b).size();
+        for(std::size_t k = 0; k < n; ++k) {
+          [[maybe_unused]] const std::size_t l[] = {
+            mm.insert(std::move(vv[k])).location()...};
+          flog_assert(std::equal(l + 1, std::end(l), l),
+            "particle fields have different locations");
+        }
+      },
+      b);
+}
+} // namespace detail
+
+/// Resize an index space that holds particle fields.
+/// The new size is chosen by the \ref topo::with_size::growth "growth
+/// policy" of its partition, which must be resizable (as for \c topo::user).
+/// The particles are compacted first; to keep other fields consistent with
+/// them, call \c mutator::compact in a task that also permutes those fields.
+/// Other fields have unspecified values at new indices.
+/// \param r a particle field
+/// \param rr any other particle fields on the same index space, which are
+///   otherwise corrupted
+template<class T, class Topo, typename Topo::index_space S, class... RR>
+void
+resize_particles(const field_reference<T, particle, Topo, S> & r,
+  const RR &... rr) {
+  auto & p = r.topology().template get_partition<S>();
+  bool first = true;
+  const auto size = [&](const auto & f) {
+    execute<detail::size_particles<
+      typename std::remove_reference_t<decltype(f)>::value_type>>(
+      f, p.sizes(), p.growth, std::exchange(first, false));
+  };
+  size(r);
+  (size(rr), ...);
+  detail::reallocate_particles(p, r, rr...);
+}
+
+/// Move particles between colors, as for a \ref topo::set "set" whose
+/// particles have moved to cells of other colors.
+/// Each color sends only to the colors that receive its particles.
+/// Capacity is increased, according to the growth policy of the partition
+/// (which must be resizable and able to grow), where the arrivals would not
+/// fit.  There must be one color per process.
+/// \param dest function object that is called with each particle of \a r
+///   (on each color) and returns its destination color; it must be copyable
+///   and give the same result for every call with the same particle
+/// \param r a particle field
+/// \param rr any other particle fields on the same index space, which are
+///   migrated with \a r; each particle must have the same location in all
+///   the fields (as when every insertion and removal is applied to each)
+template<class F,
+  class T,
+  class Topo,
+  typename Topo::index_space S,
+  class... RR>
+void
+migrate_particles(const F & dest,
+  const field_reference<T, particle, Topo, S> & r,
+  const RR &... rr) {
+  using D = std::decay_t<F>; // functions are passed as pointers
+  auto & p = r.topology().template get_partition<S>();
+  if(reduce<detail::count_migrants<D, T>, exec::fold::max, flecsi::mpi>(
+       dest, r, p.sizes(), p.growth)
+       .get())
+    detail::reallocate_particles(p, r, rr...);
+  execute<detail::migrate_particles<D, T, typename RR::value_type...>,
+    flecsi::mpi>(dest, r, rr...);
+}
+
 namespace detail {
 template<class T>
 struct scalar_value : bind_tag {
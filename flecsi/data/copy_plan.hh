@@ -10,6 +10,11 @@
 #include "flecsi/topo/index.hh"
 #include "flecsi/util/serialize.hh"
 
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
 // This will need to support different kind of constructors for
 // src vs dst
 // indirect vs direct
@@ -105,6 +110,7 @@ struct buffers_base {
   /// used for transferring arbitrary data via serialization.
   struct buffer {
     /// An input stream for a buffer.
+    /// It continues into any further pages for the same edge.
     struct reader {
       // Use to select a type to read from context.
       struct convert {
@@ -116,9 +122,9 @@ struct buffers_base {
         }
       };
 
-      const buffer * b;
-      const std::byte * p = b->data.data();
-      std::size_t i = 0;
+      reader(const buffer * b) : b(b) {
+        turn();
+      }
 
       explicit operator bool() const { // false if at end
         return i < b->len;
@@ -126,43 +132,71 @@ struct buffers_base {
       template<class T>
       T get() {
         ++i;
-        return util::serial::get<T>(p);
+        auto ret = util::serial::get<T>(p);
+        turn();
+        return ret;
       }
       convert operator()() {
         return {this};
       }
+
+    private:
+      void turn() { // skip to the next page with data, if any
+        while(i == b->len && b->next) {
+          b += b->next;
+          p = b->data.data();
+          i = 0;
+        }
+      }
+
+      const buffer * b;
+      const std::byte * p = b->data.data();
+      std::size_t i = 0;
     };
     /// An output stream for a buffer.
+    /// It continues into any further pages for the same edge.
     struct writer {
-      explicit writer(buffer & b) : b(&b) {
-        b.len = 0;
+      explicit writer(buffer & b) : b(&b), c(&b) {
+        for(auto * q = c;; q += q->next) {
+          q->len = 0;
+          if(!q->next)
+            break;
+        }
       }
       writer(writer &&) = default; // actually a copy, but don't do it casually
 
+      /// Get the first page, whose \c off is not used by the writer.
       buffer & get_buffer() const {
         return *b;
       }
       template<class T>
       bool operator()(const T & t) { // false if full
-        std::size_t o = p - b->data.data();
-        util::serial::put(o, t);
-        const bool ret = o <= size;
-        if(ret) {
-          util::serial::put(p, t);
-          ++b->len;
+        for(;;) {
+          std::size_t o = p - c->data.data();
+          util::serial::put(o, t);
+          if(o <= size) {
+            util::serial::put(p, t);
+            ++c->len;
+            return true;
+          }
+          if(!c->next)
+            return false;
+          c += c->next;
+          p = c->data.data();
         }
-        return ret;
       }
 
     private:
-      buffer * b;
+      buffer *b, *c; // first and current pages
       std::byte * p = b->data.data();
     };
 
     // Provided for convenience in transferring multiple objects in data:
     std::size_t off, len; // off ignored by stream helpers
+    std::size_t next; // distance to the next page for the same edge, or 0
     static constexpr std::size_t page = 1 << 12,
-                                 size = page - sizeof off - sizeof len;
+                                 size =
+                                   page - sizeof off - sizeof len - sizeof next;
     std::array<std::byte, size> data;
 
     reader read() const & {
@@ -177,21 +211,39 @@ struct buffers_base {
 
 protected:
   using Intervals = std::vector<subrow>;
-  using Points = std::vector<std::vector<points::Value>>;
+  // Destination index and source point for each receive page:
+  using Points =
+    std::vector<std::vector<std::pair<std::size_t, points::Value>>>;
+
+  static std::size_t uniform(std::size_t n, Color) {
+    return n;
+  }
 
   static void set_dests(field<data::intervals::Value>::accessor<wo> a,
-    const Intervals & v) {
-    assert(a.span().size() == 1);
+    const Intervals & v,
+    std::size_t w) {
     const auto i = color();
-    a.span().front() = data::intervals::make(v[i], i);
+    std::size_t o = 0;
+    for(auto & d : a.span()) {
+      d = data::intervals::make({v[i].first + o, v[i].second + o}, i);
+      o += w;
+    }
   }
   static void set_ptrs(field<points::Value>::accessor<wo, wo> a,
     const Points & v) {
-    auto & v1 = v[run::context::instance().color()];
-    const auto n = v1.size();
-    // Our ghosts are always a suffix:
-    assert(n <= a.span().size());
-    std::copy(v1.begin(), v1.end(), a.span().end() - n);
+    const auto s = a.span();
+    for(auto & [i, p] : v[run::context::instance().color()]) {
+      assert(i < s.size());
+      s[i] = p;
+    }
+  }
+  static void set_links(flecsi::field<buffer>::accessor<wo, wo> a,
+    std::size_t w) {
+    const auto s = a.span();
+    for(std::size_t i = 0; i < s.size(); ++i) {
+      s[i].len = 0;
+      s[i].next = i + w < s.size() ? w : 0;
+    }
   }
 };
 
@@ -199,25 +251,32 @@ template<class P>
 struct buffers_category : buffers_base, topo::array_category<P> {
   using buffers_base::coloring; // to override that from array_category
 
-  explicit buffers_category(const coloring & c)
-    : buffers_category(c, [&c] {
-        Points ret(c.size());
-        Color i = 0;
-        for(auto & s : c) {
-          std::size_t j = 0;
-          for(auto & d : s)
-            ret[d].push_back(points::make(i, j++));
-          ++i;
-        }
-        return ret;
-      }()) {}
+  /*!
+   Each edge starts with one page.
+   \param c communication graph
+   \param max maximum number of pages per edge: if greater than 1, whenever
+     \c xfer needs several rounds, the number is increased (geometrically)
+     for the next transfer so as to need only one
+  */
+  explicit buffers_category(const coloring & c, std::size_t max = 1)
+    : topo::array_category<P>(topo::array_base::coloring(c.size(), width(c))),
+      graph(c), w(width(c)), limit(max) {
+    plan();
+  }
 
-  /// Low indices are send buffers, in the order specified in the graph;
-  /// higher indices are receive buffers, in order of sending color.
+  /// Send buffers are at indices less than the number of destinations, in
+  /// the order specified in the graph; receive buffers follow, in order of
+  /// sending color.  Further pages, if any, are reached by the stream
+  /// helpers; other indices are unused.
   auto operator*() {
     return field(*this);
   }
 
+  /// Get the number of pages for each edge.
+  std::size_t pages() const {
+    return k;
+  }
+
   /*!
    This method is used to invoke the sending and receiving of data.
    @tparam F Function object, executing F initializes and loads the send
@@ -238,50 +297,71 @@ struct buffers_category : buffers_base, topo::array_category<P> {
   template<auto & F, auto & G, class... AA>
   void xfer(AA &&... aa) {
     execute<F>(aa..., **this);
+    std::size_t n = 1;
     while(reduce<G, exec::fold::max>(aa..., **this).get())
-      ;
+      ++n;
+    if(n > 1 && k < limit) {
+      auto g = k;
+      while(g < k * n)
+        g *= 2;
+      k = std::min(g, limit);
+      this->resize(make_partial<uniform>(w * k));
+      plan();
+    }
   }
 
   // Data is actually moved by ordinary ghost copies for buffer accessors:
   template<class R>
   void ghost_copy(const R & f) {
-    cp.issue_copy(f.fid());
+    cp->issue_copy(f.fid());
   }
 
   static inline const flecsi::field<buffer>::definition<P> field;
 
 private:
-  /*!
-   This constructor takes two different representations of the same
-   communication graph.
-   @param c The global communication graph
-   @param recv It has the actual source coordinates (color and source-local
-   index) for each buffer to be received.
-  */
-  buffers_category(const coloring & c, const Points & recv)
-    : topo::array_category<P>([&] {
-        topo::array_base::coloring ret;
-        ret.reserve(c.size());
-        auto * p = recv.data();
-        for(auto & s : c)
-          ret.push_back(s.size() + p++->size());
-        return ret;
-      }()),
-      cp(
-        *this,
-        *this,
-        copy_plan::Sizes(c.size(), 1),
-        [&](auto f) {
-          Intervals ret;
-          ret.reserve(c.size());
-          auto * p = recv.data();
-          for(auto & s : c)
-            ret.push_back({s.size(), s.size() + p++->size()});
-          execute<set_dests>(f, ret);
-        },
-        [&](auto f) { execute<set_ptrs>(f, recv); }) {}
-
-  copy_plan cp;
+  // The number of buffers for each page: the greatest number of edges on
+  // any color, so that the pages for an edge are equally spaced everywhere.
+  static std::size_t width(const coloring & c) {
+    std::vector<std::size_t> n(c.size());
+    Color i = 0;
+    for(auto & s : c) {
+      n[i++] += s.size();
+      for(auto d : s)
+        ++n[d];
+    }
+    return n.empty() ? 0 : *std::max_element(n.begin(), n.end());
+  }
+
+  // Create the copy plan for the current number of pages.
+  void plan() {
+    const Color nc = graph.size();
+    Intervals iv;
+    iv.reserve(nc);
+    for(auto & s : graph)
+      iv.push_back({s.size(), s.size()});
+    Points pp(nc);
+    Color i = 0;
+    for(auto & s : graph) {
+      std::size_t j = 0;
+      for(auto d : s) {
+        const auto r = iv[d].second++;
+        for(std::size_t q = 0; q < k; ++q)
+          pp[d].emplace_back(q * w + r, points::make(i, q * w + j));
+        ++j;
+      }
+      ++i;
+    }
+    cp.emplace(*this,
+      *this,
+      copy_plan::Sizes(nc, k),
+      [&](auto f) { execute<set_dests>(f, iv, w); },
+      [&](auto f) { execute<set_ptrs>(f, pp); });
+    execute<set_links>(**this, w);
+  }
+
+  coloring graph;
+  std::size_t w, k = 1, limit;
+  std::optional<copy_plan> cp;
 };
 } // namespace detail
   /// \}
@@ -303,8 +383,9 @@ struct buffers : topo::specialization<detail::buffers_category, buffers> {
 
   /// Alias Start is used to provide accessor to the sending buffers. It should
   /// be part of the signature of the two function objects (F, G) needed by the
-  /// "xfer" method of underlying buffers_category.
-  using Start = field<Buffer>::accessor<wo, na>;
+  /// "xfer" method of underlying buffers_category.  It uses rw so as to
+  /// preserve the links between the pages for each edge.
+  using Start = field<Buffer>::accessor<rw, na>;
   /// Alias Transfer is used to provide accessor to the receiving buffers. It
   /// should be part of the signature of the two function objects (F, G) needed
   /// by the "xfer" method of underlying buffers_category. Since copy_plan
@@ -323,6 +404,10 @@ struct buffers : topo::specialization<detail::buffers_category, buffers> {
   /// Each iteration should start sending data from the beginning:
   /// \c operator() will ignore data that has already been sent.
   struct ragged {
+    /// A page limit for buffers used for ragged ghost copies, so that most
+    /// finish in one round.
+    static constexpr std::size_t pages = 64;
+
     /*!
       Prepare an object for writing.
 
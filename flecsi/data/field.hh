@@ -6,11 +6,14 @@
 
 #include "flecsi/data/topology_slot.hh"
 #include "flecsi/run/backend.hh"
+#include "flecsi/util/constant.hh"
 #include "flecsi/util/demangle.hh"
 #include "flecsi/util/target.hh"
 #include <flecsi/data/layout.hh>
 #include <flecsi/data/privilege.hh>
 
+#include <tuple>
+
 namespace flecsi {
 namespace topo {
 struct with_cleanup; // defined in terms of cleanup
@@ -333,6 +336,7 @@ struct field : data::detail::field_base<T, L> {
   struct definition : Register<Topo, Space> {
     using Topology = Topo;
     using Field = field;
+    static constexpr auto space = Space;
 
     /// Return a reference to a field instance.
     /// \param t topology instance (must be allocated)
@@ -367,6 +371,39 @@ struct field : data::detail::field_base<T, L> {
   using reduction = reduction_accessor<R, T>;
 #endif
 };
+
+/// A layout hint for dense fields that are used together.
+/// With Legion, the fields share one physical instance (each remains
+/// contiguous), which is created (or reused) whenever any of them is mapped.
+/// Other backends ignore the hint.  For an interleaved (array-of-structures)
+/// layout, use one field whose type is a structure instead.
+///
+/// Declare groups like field definitions, before any instance of the
+/// topology is created, naming each field at most once.
+struct field_group {
+  /// Group field definitions.
+  /// \param dd \c definition objects for the same index space
+  template<class... DD>
+  explicit field_group(const DD &... dd) {
+    static_assert(sizeof...(DD) > 1, "a group needs several fields");
+    static_assert(
+      (std::is_same_v<typename DD::Field,
+         field<typename DD::Field::value_type>> &&
+        ...),
+      "only dense fields can be grouped");
+    static_assert((std::is_same_v<typename DD::Topology,
+                     typename std::tuple_element_t<0,
+                       std::tuple<DD...>>::Topology> &&
+                    ...),
+      "grouped fields must belong to one topology");
+    static_assert((std::is_same_v<util::constant<DD::space>,
+                     util::constant<std::tuple_element_t<0,
+                       std::tuple<DD...>>::space>> &&
+                    ...),
+      "grouped fields must belong to one index space");
+    run::context::add_field_group({dd.fid...});
+  }
+};
 /// \}
 
 namespace data {
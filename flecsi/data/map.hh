@@ -12,8 +12,8 @@ namespace flecsi {
 namespace data::launch {
 /// \defgroup launch Launch maps
 /// Selecting topology colors to send to tasks.
-/// \warning Only the Legion backend supports non-trivial mappings that select
-///   any color but their own.
+/// \warning The MPI backend supports only mappings that select colors held by
+///   the same process.
 /// \ingroup data
 /// \{
 
@@ -5,18 +5,35 @@
 #define FLECSI_DATA_MPI_POLICY_HH
 
 #include "flecsi/data/field_info.hh"
+#include "flecsi/data/privilege.hh"
 #include "flecsi/exec/task_attributes.hh"
 #include "flecsi/run/backend.hh"
 #include "flecsi/util/array_ref.hh"
 #include "flecsi/util/mpi.hh"
+#include "flecsi/util/profile.hh"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#if defined(FLECSI_ENABLE_KOKKOS) && __has_include(<mpi-ext.h>)
+#include <mpi-ext.h> // for MPIX_Query_cuda_support
+#endif
+
 namespace flecsi {
 namespace data {
 namespace mpi {
@@ -46,33 +63,151 @@ using device_const_view = Kokkos::View<const std::byte *,
 using view_variant = std::variant<host_view, device_view>;
 #endif
 
+// The host memory for all the fields of a region.  Each field occupies a
+// slot in one of a few blocks.  When a field grows, the new block also has
+// room for every other field that has so far requested the same number of
+// elements, so that a region whose fields grow together uses a single
+// allocation while fields that grow independently do not reserve memory for
+// each other.  A slot that must grow moves to its place in a newer block,
+// copying only its contents; other fields never move.  New elements are
+// zero-filled, as ragged offsets (for example) require.
+struct arena {
+  static constexpr std::size_t alignment = 64;
+  // Blocks at least this large are aligned for, and advised to use, huge
+  // pages where supported.
+  static constexpr std::size_t huge = std::size_t(1) << 21;
+
+  explicit arena(std::vector<std::size_t> ts)
+    : type_size(std::move(ts)), slots(type_size.size()) {}
+  arena(arena &&) = delete;
+
+  std::byte * data(std::size_t i) const {
+    return slots[i].at.p;
+  }
+  std::size_t size(std::size_t i) const {
+    return slots[i].size;
+  }
+
+  void resize(std::size_t i, std::size_t n) {
+    auto & s = slots[i];
+    if(n > s.at.capacity) {
+      if(n > s.reserved.capacity)
+        // Leave room for further growth as std::vector would.
+        reserve(i, s.at.capacity ? std::max(n, s.at.capacity * 3 / 2) : n);
+      if(s.size)
+        std::memcpy(s.reserved.p, s.at.p, s.size);
+      release(s.at);
+      s.at = std::exchange(s.reserved, {});
+    }
+    if(n > s.size)
+      std::memset(s.at.p + s.size, 0, n - s.size);
+    s.size = n;
+  }
+
+private:
+  struct block {
+    explicit block(std::size_t n) {
+      const std::size_t a = n >= huge ? huge : alignment;
+      p = static_cast<std::byte *>(std::aligned_alloc(a, round(n, a)));
+      flog_assert(p != nullptr, "memory allocation failed");
+#ifdef MADV_HUGEPAGE
+      if(a == huge)
+        madvise(p, round(n, a), MADV_HUGEPAGE);
+#endif
+    }
+    block(block &&) = delete;
+    ~block() {
+      std::free(p);
+    }
+
+    std::byte * p;
+    std::size_t refs = 0;
+  };
+  struct place {
+    block * b = nullptr;
+    std::byte * p = nullptr;
+    std::size_t capacity = 0;
+  };
+  struct slot {
+    place at, reserved;
+    std::size_t size = 0;
+  };
+
+  static std::size_t round(std::size_t n, std::size_t a = alignment) {
+    return (n + a - 1) / a * a;
+  }
+
+  // Lay out a block with n bytes for slot i and the same number of elements
+  // for every other nonempty slot that holds as many elements as slot i and
+  // lacks that much room already.
+  void reserve(std::size_t i, std::size_t n) {
+    const std::size_t elements = (n + type_size[i] - 1) / type_size[i],
+                      current = slots[i].size / type_size[i];
+    std::vector<std::pair<std::size_t, std::size_t>> want; // slot, bytes
+    std::size_t total = 0;
+    for(std::size_t j = 0; j < slots.size(); ++j) {
+      const std::size_t b = j == i ? n : elements * type_size[j];
+      const auto & s = slots[j];
+      if(j == i || (s.size && s.size / type_size[j] == current &&
+                     b > s.at.capacity && b > s.reserved.capacity)) {
+        want.emplace_back(j, round(b));
+        total += round(b);
+      }
+    }
+    auto & k = *blocks.emplace_back(std::make_unique<block>(total));
+    std::size_t off = 0;
+    for(const auto & [j, b] : want) {
+      auto & r = slots[j].reserved;
+      release(r);
+      r = {&k, k.p + off, b};
+      ++k.refs;
+      off += b;
+    }
+  }
+
+  void release(place & p) {
+    if(p.b && !--p.b->refs)
+      blocks.erase(std::find_if(blocks.begin(), blocks.end(), [&](auto & b) {
+        return b.get() == p.b;
+      }));
+    p = {};
+  }
+
+  std::vector<std::size_t> type_size;
+  std::vector<slot> slots;
+  std::vector<std::unique_ptr<block>> blocks;
+};
+
 struct buffer {
+  buffer(arena & a, std::size_t i) : a(&a), i(i) {}
+
   template<exec::task_processor_type_t ProcessorType =
              exec::task_processor_type_t::loc>
-  std::byte * data() {
-    return v.data();
+  std::byte * data(partition_privilege_t = rw) {
+    return a->data(i);
   }
 
   std::size_t size() const {
-    return v.size();
+    return a->size(i);
   }
 
 #if defined(FLECSI_ENABLE_KOKKOS)
   auto kokkos_view() {
-    return host_view{v.data(), v.size()};
+    return host_view{data(), size()};
   }
 
   auto kokkos_view() const {
-    return host_const_view{v.data(), v.size()};
+    return host_const_view{a->data(i), size()};
   }
 #endif
 
   void resize(std::size_t size) {
-    v.resize(size);
+    a->resize(i, size);
   }
 
 private:
-  std::vector<std::byte> v;
+  arena * a;
+  std::size_t i;
 };
 
 #if defined(FLECSI_ENABLE_KOKKOS)
@@ -116,66 +251,124 @@ private:
   std::byte * ptr = nullptr;
 };
 
+// The host and device copies of a field.  Each copy is current or stale;
+// a stale copy is brought up to date only when a task on its side reads it,
+// and then only in the byte ranges in which it differs from the other if
+// those are known (as after a ghost copy into the other).
 struct storage {
+  storage(arena & a, std::size_t i) : loc_buffer(a, i) {}
+
+  // Return the copy for a task on a processor type that uses it with the
+  // given privilege.
   template<exec::task_processor_type_t ProcessorType>
-  std::byte * data() {
+  std::byte * data(partition_privilege_t p = rw) {
     // HACK to treat mpi processor type as loc
-    if constexpr(ProcessorType == exec::task_processor_type_t::mpi)
-      return data<exec::task_processor_type_t::loc>();
-
-    if(is_on != ProcessorType) {
-      if(is_on == exec::task_processor_type_t::loc) {
-        transfer(toc_buffer, loc_buffer);
-      }
-      else {
-        transfer(loc_buffer, toc_buffer);
+    constexpr bool host = ProcessorType == exec::task_processor_type_t::loc ||
+                          ProcessorType == exec::task_processor_type_t::mpi;
+    const std::size_t n = size();
+    bool & mine = host ? on_host : on_device;
+    bool & theirs = host ? on_device : on_host;
+    if(!mine && p != na) {
+      if(p != wo) {
+        if constexpr(host)
+          transfer(loc_buffer, toc_buffer);
+        else
+          transfer(toc_buffer, loc_buffer);
       }
+      mine = true;
+      stale.clear();
+    }
+    if(privilege_write(p)) {
+      theirs = false;
+      stale.clear();
     }
-    is_on = ProcessorType;
 
-    if constexpr(ProcessorType == exec::task_processor_type_t::loc)
-      return loc_buffer.data();
+    if constexpr(host)
+      return fit(loc_buffer, n);
     else
-      return toc_buffer.data();
+      return fit(toc_buffer, n);
   }
 
+  // Return a current copy, preferring the host's.
   view_variant kokkos_view() {
-    if(is_on == exec::task_processor_type_t::loc) {
+    if(on_host)
       return {loc_buffer.kokkos_view()};
-    }
-    else {
+    else
       return {toc_buffer.kokkos_view()};
+  }
+
+  // Record that the copy returned by kokkos_view was modified in the given
+  // byte ranges.
+  void modified(const std::vector<std::pair<std::size_t, std::size_t>> & r) {
+    if(r.empty())
+      return;
+    if(on_host && on_device) {
+      on_device = false;
+      stale = r;
+    }
+    else if(!stale.empty()) {
+      stale.insert(stale.end(), r.begin(), r.end());
+      std::sort(stale.begin(), stale.end());
+      auto o = stale.begin();
+      for(auto i = o + 1; i != stale.end(); ++i)
+        if(i->first <= o->second)
+          o->second = std::max(o->second, i->second);
+        else
+          *++o = *i;
+      stale.erase(o + 1, stale.end());
     }
   }
 
   std::size_t size() const {
-    if(is_on == exec::task_processor_type_t::loc)
+    if(on_host)
       return loc_buffer.size();
     else
       return toc_buffer.size();
   }
 
   void resize(std::size_t size) {
-    if(is_on == exec::task_processor_type_t::loc) {
+    // Preserve each copy whose contents might be used.
+    const bool partial = !stale.empty();
+    if(on_host || partial)
       loc_buffer.resize(size);
-    }
-    else {
+    if(on_device || partial)
       toc_buffer.resize(size);
-    }
   }
 
 private:
+  template<typename B>
+  static std::byte * fit(B & b, std::size_t n) {
+    if(b.size() < n)
+      b.resize(n);
+    return b.data();
+  }
+
   template<typename D, typename S>
-  static void transfer(D & dst, const S & src) {
+  void transfer(D & dst, const S & src) {
     // We need to resize buffer on the destination side such that we don't
     // attempt deep_copy to cause buffer overrun (Kokkos does check that).
-    if(dst.size() < src.size())
-      dst.resize(src.size());
-    Kokkos::deep_copy(
-      Kokkos::DefaultExecutionSpace{}, dst.kokkos_view(), src.kokkos_view());
+    const std::size_t n = src.size();
+    fit(dst, n);
+    const auto d = dst.kokkos_view();
+    const auto s = src.kokkos_view();
+    const auto copy = [&](std::size_t b, std::size_t e) {
+      if(b < e)
+        Kokkos::deep_copy(Kokkos::DefaultExecutionSpace{},
+          Kokkos::subview(d, std::make_pair(b, e)),
+          Kokkos::subview(s, std::make_pair(b, e)));
+    };
+    if(stale.empty())
+      copy(0, n);
+    else
+      for(const auto & [b, e] : stale)
+        copy(b, std::min(e, n));
+    Kokkos::DefaultExecutionSpace{}.fence();
   }
 
-  exec::task_processor_type_t is_on = exec::task_processor_type_t::loc;
+  bool on_host = true, on_device = false;
+  // If only one copy is current, the byte ranges in which the other differs
+  // (or empty if it might differ anywhere)
+  std::vector<std::pair<std::size_t, std::size_t>> stale;
   // We don't need to worry about the case that ExecutionSpace is actually
   // HostSpace (e.g. OpenMP) since currently default_accelerator == toc only
   // when compiling for CUDA or HIP.
@@ -184,6 +377,50 @@ private:
   buffer_impl_loc loc_buffer;
   buffer_impl_toc toc_buffer;
 };
+
+// Whether the memory of the execution space can be used directly on the host.
+inline constexpr bool host_accessible = Kokkos::SpaceAccessibility<
+  Kokkos::DefaultHostExecutionSpace,
+  Kokkos::DefaultExecutionSpace::memory_space>::accessible;
+
+// Whether MPI can send from and receive into execution-space memory.
+inline bool
+mpi_accessible() {
+  if constexpr(host_accessible)
+    return true;
+#if defined(KOKKOS_ENABLE_CUDA) && defined(MPIX_CUDA_AWARE_SUPPORT) &&         \
+  MPIX_CUDA_AWARE_SUPPORT
+  static const bool ret = MPIX_Query_cuda_support();
+  return ret;
+#elif defined(KOKKOS_ENABLE_HIP) && defined(MPIX_ROCM_AWARE_SUPPORT) &&        \
+  MPIX_ROCM_AWARE_SUPPORT
+  static const bool ret = MPIX_Query_rocm_support();
+  return ret;
+#else
+  return false;
+#endif
+}
+
+// Copy n values of the given size from src[si[i]] to dst[di[i]] in the
+// execution space, where a null index array means the identity.  All the
+// arguments must be in execution-space memory.
+inline void
+device_copy(std::byte * dst,
+  const std::size_t * di,
+  const std::byte * src,
+  const std::size_t * si,
+  std::size_t n,
+  std::size_t type_size) {
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace>(0, n),
+    KOKKOS_LAMBDA(const std::size_t i) {
+      // Yes, memcpy is supported on device as long as there is no std::
+      // qualifier.
+      memcpy(dst + (di ? di[i] : i) * type_size,
+        src + (si ? si[i] : i) * type_size,
+        type_size);
+    });
+}
 #else // !defined(FLECSI_ENABLE_KOKKOS)
 using storage = buffer;
 #endif // defined(FLECSI_ENABLE_KOKKOS)
@@ -192,70 +429,140 @@ using storage = buffer;
 struct region_impl {
   // The constructor is collectively called on all ranks with the same s,
   // and fs. s.first is number of rows while s.second is number of columns.
-  // MPI may assume "number of rows" == number of ranks. The number of columns
-  // is a placeholder for the number of data points to be stored in a
-  // particular row (aka rank), it could be exact or in the case when we don't
-  // know the exact number yet, a large number (flecsi::data::logical_size) is
-  // used.
+  // Each rank holds a contiguous block of the rows if their number is a
+  // multiple of the number of ranks; otherwise, it is assumed that "number of
+  // rows" == number of ranks (or that every rank holds a copy of the only
+  // row). The number of columns is a placeholder for the number of data points
+  // to be stored in a particular row (aka color), it could be exact or in the
+  // case when we don't know the exact number yet, a large number
+  // (flecsi::data::logical_size) is used.
   //
   // Generic frontend code supplies `s` and `fs` (for information about fields),
   // requesting memory to be (notionally) reserved from backend. Here we only
-  // create the underlying std::vector<> without actually allocating any memory.
-  // The client code (mostly exec::task_prologue) will call .get_storage() with
-  // a field id and the number of elements on this rank, as determined by
-  // partitioning of the field. We will then call .resize() on the
-  // std::vector<>.
-  region_impl(size2 s, const fields & fs) : s(std::move(s)), fs(fs) {
-    for(const auto & f : fs) {
-      storages[f->fid];
+  // create a slot in the arena of each local row for each field without
+  // actually allocating any memory. The client code (mostly
+  // exec::task_prologue) will call .get_storage() with a field id and the
+  // number of elements in the row of the current task, as determined by
+  // partitioning of the field. We will then grow that slot.
+  region_impl(size2 s, const fields & fs)
+    : s(std::move(s)), fs(fs),
+      first(run::context::instance().local_colors(this->s.first).first) {
+    std::vector<std::size_t> ts;
+    for(std::size_t i = 0; i < fs.size(); ++i) {
+      const field_id_t f = fs[i]->fid;
+      if(f >= index.size())
+        index.resize(f + 1, fs.size());
+      index[f] = i;
+      ts.push_back(std::max<std::size_t>(fs[i]->type_size, 1));
     }
+    for(Color c = run::context::instance().local_colors(this->s.first).second;
+        c--;)
+      shards.emplace_back(ts);
   }
 
   size2 size() const {
     return s;
   }
 
+  // The number of rows held by this rank.
+  Color local_rows() const {
+    return shards.size();
+  }
+  // The row for the current task.
+  Color local_row() const {
+    if(shards.size() == 1)
+      return 0;
+    const Color ret = run::context::instance().color() - first;
+    flog_assert(ret < shards.size(),
+      "color " << run::context::instance().color() << " is not held here");
+    return ret;
+  }
+  // The color of a local row.
+  Color color(Color i) const {
+    return first + i;
+  }
+
   // The span is safe because it is used only within a user task while the
-  // vectors are resized or destroyed only outside user tasks (though perhaps
+  // slots are resized or destroyed only outside user tasks (though perhaps
   // during execute).
+  // The privilege P determines whether the other copy of the field (if any)
+  // must be updated or becomes stale.
   template<class T,
     exec::task_processor_type_t ProcessorType =
-      exec::task_processor_type_t::loc>
+      exec::task_processor_type_t::loc,
+    partition_privilege_t P = rw>
   util::span<T> get_storage(field_id_t fid) {
-    return get_storage<T, ProcessorType>(fid, s.second);
+    return get_storage<T, ProcessorType, P>(fid, s.second);
   }
 
   template<class T,
     exec::task_processor_type_t ProcessorType =
-      exec::task_processor_type_t::loc>
+      exec::task_processor_type_t::loc,
+    partition_privilege_t P = rw>
   util::span<T> get_storage(field_id_t fid, std::size_t nelems) {
-    auto & v = storages.at(fid);
+    return get_storage<T, ProcessorType, P>(fid, nelems, local_row());
+  }
+
+  // Rows other than that of the current task are accessed only outside of
+  // user tasks.
+  template<class T,
+    exec::task_processor_type_t ProcessorType =
+      exec::task_processor_type_t::loc,
+    partition_privilege_t P = rw>
+  util::span<T>
+  get_storage(field_id_t fid, std::size_t nelems, Color row) {
+    auto & v = shards[row].storages[slot(fid)];
     std::size_t nbytes = nelems * sizeof(T);
     if(nbytes > v.size())
       v.resize(nbytes);
-    return {reinterpret_cast<T *>(v.data<ProcessorType>()), nelems};
+    return {reinterpret_cast<T *>(v.data<ProcessorType>(P)), nelems};
   }
 
 #if defined(FLECSI_ENABLE_KOKKOS)
-  auto kokkos_view(field_id_t fid) {
-    return storages.at(fid).kokkos_view();
+  // Return the current copy of a field in a row, grown to at least nbytes.
+  auto kokkos_view(field_id_t fid, Color row, std::size_t nbytes) {
+    auto & v = shards[row].storages[slot(fid)];
+    if(nbytes > v.size())
+      v.resize(nbytes);
+    return v.kokkos_view();
+  }
+  // Record a modification of the view returned by kokkos_view.
+  void modified(field_id_t fid,
+    Color row,
+    const std::vector<std::pair<std::size_t, std::size_t>> & bytes) {
+    shards[row].storages[slot(fid)].modified(bytes);
   }
 #endif
 
   auto get_field_info(field_id_t fid) const {
-    for(auto & f : fs) {
-      if(f->fid == fid)
-        return f;
-    }
-    throw std::runtime_error("can not find field");
+    return fs[slot(fid)];
   }
 
 private:
-  size2 s; // (nranks, nelems)
+  std::size_t slot(field_id_t fid) const {
+    if(fid >= index.size() || index[fid] == fs.size())
+      throw std::runtime_error("can not find field");
+    return index[fid];
+  }
+
+  // The storage for the fields in one row.
+  struct shard {
+    explicit shard(const std::vector<std::size_t> & ts) : memory(ts) {
+      for(std::size_t i = 0; i < ts.size(); ++i)
+        storages.emplace_back(memory, i);
+    }
+
+    detail::arena memory;
+    std::deque<detail::storage> storages; // indexed like fs
+  };
+
+  size2 s; // (nrows, nelems)
   fields fs; // fs[].fid is only unique within a region, i.e. r0.fs[].fid is
              // unrelated to r1.fs[].fid even if they have the same value.
 
-  std::unordered_map<field_id_t, detail::storage> storages;
+  Color first; // color of the first local row
+  std::vector<std::size_t> index; // field ID -> position in fs
+  std::deque<shard> shards; // local rows
 };
 
 struct region {
@@ -283,19 +590,28 @@ struct partition {
   partition & operator=(partition &&) & = default;
 
   Color colors() const {
-    // number of rows, essentially the number of MPI ranks.
+    // number of rows, usually the number of MPI ranks or a multiple thereof.
     return r->size().first;
   }
 
   template<typename T,
     exec::task_processor_type_t ProcessorType =
-      exec::task_processor_type_t::loc>
+      exec::task_processor_type_t::loc,
+    partition_privilege_t P = rw>
   auto get_storage(field_id_t fid) const {
-    return r->get_storage<T, ProcessorType>(fid, nelems);
+    const Color i = r->local_row();
+    return r->get_storage<T, ProcessorType, P>(fid, nelems[i], i);
+  }
+
+  // Access the storage of a local row other than the current task's.
+  template<typename T>
+  auto get_storage(field_id_t fid, Color row) const {
+    return r->get_storage<T>(fid, nelems[row], row);
   }
 
   auto get_raw_storage(field_id_t fid, std::size_t item_size) const {
-    return r->get_storage<std::byte>(fid, nelems * item_size);
+    const Color i = r->local_row();
+    return r->get_storage<std::byte>(fid, nelems[i] * item_size, i);
   }
 
   template<topo::single_space>
@@ -307,14 +623,14 @@ private:
   region_impl * r;
 
 protected:
-  partition(region & r) : r(&*r) {}
+  partition(region & r) : r(&*r), nelems(r->local_rows()) {}
 
   region_impl & get_base() const {
     return *r;
   }
 
-  // number of elements in this partition on this particular rank.
-  size_t nelems = 0;
+  // number of elements in this partition in each row on this particular rank.
+  std::vector<std::size_t> nelems;
 };
 
 } // namespace mpi
@@ -331,9 +647,9 @@ struct rows : data::partition {
   explicit rows(region & r) : partition(r) {
     // This constructor is usually (almost always) called when r.s.second != a
     // large number, meaning it has the actual value. In this case, r.s.second
-    // is the number of elements in the partition on this rank (the same value
+    // is the number of elements in the partition in each row (the same value
     // on all ranks though).
-    nelems = r.size().second;
+    std::fill(nelems.begin(), nelems.end(), r.size().second);
   }
 };
 
@@ -348,17 +664,20 @@ struct prefixes : data::partition, prefixes_base {
 
   template<class F>
   void update(F f) {
-    // The number of elements for each ranks is stored as a field of the
-    // prefixes::row data type on the `other` partition.
-    const auto s =
-      f.get_partition().template get_storage<row>(f.fid()); // non-owning span
-    flog_assert(
-      s.size() == 1, "underlying partition must have size 1, not " << s.size());
-    nelems = s[0];
+    // The number of elements for each row is stored as a field of the
+    // prefixes::row data type on the `other` partition, which has the same
+    // rows.
+    for(Color i = 0; i < nelems.size(); ++i) {
+      const auto s = f.get_partition().template get_storage<row>(
+        f.fid(), i); // non-owning span
+      flog_assert(s.size() == 1,
+        "underlying partition must have size 1, not " << s.size());
+      nelems[i] = s[0];
+    }
   }
 
   size_t size() const {
-    return nelems;
+    return nelems[get_base().local_row()];
   }
 
   using partition::get_base;
@@ -371,27 +690,30 @@ using region_base = mpi::region;
 using mpi::rows, mpi::prefixes;
 
 struct borrow : borrow_base {
-  borrow(Claims c) {
+  borrow(Claims c) : n(c.size()) {
     auto & ctx = run::context::instance();
-    flog_assert(c.size() == ctx.processes(),
-      "sorry: MPI backend needs one selection per process");
-    auto p = ctx.process();
-    const Claim i = c[p];
-    sel = i != nil;
-    flog_assert(!sel || i == p,
-      "sorry: MPI backend does not implement cross-color access");
+    const auto [f, k] = ctx.local_colors(n);
+    flog_assert(n == ctx.processes() || k > 1,
+      "sorry: MPI backend needs one selection per color, with the same "
+      "number of colors on each process");
+    // A claim may name any color held by this process; region_impl checks
+    // that when the storage is bound.
+    claims.assign(c.begin() + f, c.begin() + f + k);
   }
 
   Color size() const {
-    return run::context::instance().processes();
+    return n;
   }
 
-  bool selected() const {
-    return sel;
+  // The color selected for the current color, or nil.
+  Claim claim() const {
+    auto & ctx = run::context::instance();
+    return claims[ctx.color() - ctx.local_colors(n).first];
   }
 
 private:
-  bool sel;
+  Color n;
+  Claims claims; // for each local color
 };
 
 struct copy_engine;
@@ -410,7 +732,7 @@ struct intervals {
     // Called by upper layer, supplied with a region and a partition. There are
     // two regions involved. The region for `r` stores real field data
     // (e.g. density, pressure etc.) as the destination of the ghost copy. It
-    // also contains the pairs of (rank, index) of shared entities on remote
+    // also contains the pairs of (color, index) of shared entities on remote
     // peers. The region and associated storage in the partition `p` contains
     // metadata on which entities are local ghosts (destination of copy) on the
     // current rank. The metadata is in the form of [beginning index, ending
@@ -422,16 +744,21 @@ struct intervals {
     // also need to copy Values from the partition and save them locally. User
     // code might change it after this constructor returns. We can not use a
     // copy assignment directly here since metadata is an util::span while
-    // ghost_ranges is a std::vector<>.
-    ghost_ranges = to_vector(p.get_storage<Value>(fid));
-    // Get The largest value of `end index` in ghost_ranges (i.e. the upper
-    // bound). This tells how much memory needs to be allocated for ghost
-    // entities.
-    if(auto iter = std::max_element(ghost_ranges.begin(),
-         ghost_ranges.end(),
-         [](Value x, Value y) { return x.second < y.second; });
-       iter != ghost_ranges.end()) {
-      max_end = iter->second;
+    // ghost_ranges is a std::vector<>. There is one such vector for each row
+    // held by the current rank.
+    for(Color i = 0; i < r->local_rows(); ++i) {
+      auto & g = ghost_ranges.emplace_back(
+        to_vector(p.get_storage<Value>(fid, i)));
+      // Get The largest value of `end index` in ghost_ranges (i.e. the upper
+      // bound). This tells how much memory needs to be allocated for ghost
+      // entities.
+      auto & m = max_end.emplace_back();
+      if(auto iter = std::max_element(g.begin(),
+           g.end(),
+           [](Value x, Value y) { return x.second < y.second; });
+         iter != g.end()) {
+        m = iter->second;
+      }
     }
   }
 
@@ -440,25 +767,25 @@ private:
   friend copy_engine;
 
   template<typename T>
-  auto get_storage(field_id_t fid) const {
-    return r->get_storage<T>(fid, max_end);
+  auto get_storage(field_id_t fid, Color row, std::size_t n = 1) const {
+    return r->get_storage<T>(fid, max_end[row] * n, row);
   }
 
 #if defined(FLECSI_ENABLE_KOKKOS)
-  auto kokkos_view(field_id_t fid) const {
-    return r->kokkos_view(fid);
+  auto kokkos_view(field_id_t fid, Color row, std::size_t n = 1) const {
+    return r->kokkos_view(fid, row, max_end[row] * n);
   }
 #endif
 
   mpi::region_impl * r;
 
-  // Locally cached metadata on ranges of ghost index.
-  std::vector<Value> ghost_ranges;
-  std::size_t max_end = 0;
+  // Locally cached metadata on ranges of ghost index, for each local row.
+  std::vector<std::vector<Value>> ghost_ranges;
+  std::vector<std::size_t> max_end;
 };
 
 struct points {
-  using Value = std::pair<std::size_t, std::size_t>; // (rank, index)
+  using Value = std::pair<std::size_t, std::size_t>; // (color, index)
   static Value make(std::size_t r, std::size_t i) {
     return {r, i};
   }
@@ -475,65 +802,109 @@ private:
   mpi::region_impl * r;
 };
 
-// Copy/Paste from cppreference.com to make std::visit looks more
-// like pattern matching in ML or Haskell.
-template<class... Ts>
-struct overloaded : Ts... {
-  using Ts::operator()...;
-};
-// explicit deduction guide (not needed as of C++20)
-template<class... Ts>
-overloaded(Ts...) -> overloaded<Ts...>;
-
 struct copy_engine {
   // One copy engine for each entity type i.e. vertex, cell, edge.
   copy_engine(const points & points,
     const intervals & intervals,
     field_id_t meta_fid /* for remote shared entities */)
-    : source(points), destination(intervals) {
+    : source(points), destination(intervals),
+      max_local_source_idx(source.r->local_rows()) {
     // There is no information about the indices of local shared entities,
-    // ranks and indices of the destination of copy i.e. (local source
-    // index, {(remote dest rank, remote dest index)}). We need to do a shuffle
-    // operation to reconstruct this info from {(local ghost index, remote
-    // source rank, remote source index)}.
-    auto remote_sources =
-      destination.get_storage<const points::Value>(meta_fid);
-    // Essentially a GroupByKey of remote_sources, keys are the remote source
-    // ranks and values are vectors of remote source indices.
-    SendPoints remote_shared_entities;
-    for(const auto & [begin, end] : destination.ghost_ranges) {
-      for(auto ghost_idx = begin; ghost_idx < end; ++ghost_idx) {
-        const auto & shared = remote_sources[ghost_idx];
-        remote_shared_entities[shared.first].emplace_back(shared.second);
-        // We also group local ghost entities into
-        // (src rank, { local ghost ids})
-        ghost_entities[shared.first].emplace_back(ghost_idx);
+    // colors and indices of the destination of copy i.e. (local source
+    // index, {(remote dest color, remote dest index)}). We need to do a
+    // shuffle operation to reconstruct this info from {(local ghost index,
+    // remote source color, remote source index)}.
+    auto & ctx = run::context::instance();
+    const Color colors = source.r->size().first;
+    const auto owner = [&ctx, k = ctx.local_colors(colors).second](Color c) {
+      return c / k;
+    };
+    // Essentially a GroupByKey of remote_sources, keys are the ranks that
+    // hold the remote source colors and values are the remote source indices
+    // for each pair of colors.
+    std::map<Color, Edges> remote_shared_entities;
+    for(Color i = 0; i < destination.r->local_rows(); ++i) {
+      const Color d = destination.r->color(i);
+      auto remote_sources =
+        destination.get_storage<const points::Value>(meta_fid, i);
+      for(const auto & [begin, end] : destination.ghost_ranges[i]) {
+        for(auto ghost_idx = begin; ghost_idx < end; ++ghost_idx) {
+          const auto & [c, j] = remote_sources[ghost_idx];
+          const Edge e(c, d);
+          remote_shared_entities[owner(c)][e].emplace_back(j);
+          // We also group local ghost entities into
+          // (src rank, {(src color, dest color), { local ghost ids}})
+          ghost_entities[owner(c)][e].emplace_back(ghost_idx);
+        }
       }
     }
 
     // Create the inverse mapping of group_shared_entities. This creates a map
-    // from remote destination rank to a vector of *local* source indices. This
-    // information is later used by MPI_Send().
-    {
-      std::size_t r = 0;
-      for(auto & v : util::mpi::all_to_allv([&](int r) -> auto & {
-            static const std::vector<std::size_t> empty;
-            const auto i = remote_shared_entities.find(r);
-            return i == remote_shared_entities.end() ? empty : i->second;
-          })) {
-        if(!v.empty())
-          shared_entities.try_emplace(r, std::move(v));
-        ++r;
-      }
+    // from remote destination rank to the *local* source indices for each
+    // pair of colors. This information is later used by MPI_Send().  Only
+    // neighbors communicate; pairs of colors on the same rank are copied
+    // directly.
+    for(auto & [r, v] :
+      util::mpi::sparse_all_to_allv(remote_shared_entities))
+      shared_entities.try_emplace(r, std::move(v));
+    if(const auto i = shared_entities.find(ctx.process());
+       i != shared_entities.end()) {
+      local_entities = std::move(i->second);
+      shared_entities.erase(i);
+      local_ghosts = std::move(ghost_entities.at(ctx.process()));
+      ghost_entities.erase(ctx.process());
     }
 
-    // We need to figure out the max local source index in order to give correct
-    // nelems when calling region::get_storage().
-    for(const auto & [rank, indices] : shared_entities) {
-      max_local_source_idx = std::max(max_local_source_idx,
-        *std::max_element(indices.begin(), indices.end()));
+    // We need to figure out the max local source index in each row in order
+    // to give correct nelems when calling region::get_storage().
+    const auto grow = [&](const Edges & ee) {
+      for(const auto & [e, indices] : ee) {
+        auto & m = max_local_source_idx[e.first - source.r->color(0)];
+        m = std::max(m, *std::max_element(indices.begin(), indices.end()) + 1);
+      }
+    };
+    for(const auto & [rank, ee] : shared_entities)
+      grow(ee);
+    grow(local_entities);
+
+    // Separate the peers on this node, which exchange values through shared
+    // memory.  Each process packs all the values for them into its segment,
+    // and each peer is told where its values are.
+    const MPI_Comm node = ctx.node();
+    {
+      const auto ranks = util::mpi::all_gatherv(int(ctx.process()), node);
+      for(std::size_t i = 0; i < ranks.size(); ++i)
+        node_rank.emplace(ranks[i], int(i));
+    }
+    const auto separate = [&](SendPoints & from, SendPoints & to) {
+      for(auto i = from.begin(); i != from.end();)
+        if(node_rank.count(i->first))
+          to.insert(from.extract(i++));
+        else
+          ++i;
+    };
+    separate(shared_entities, node_shared);
+    separate(ghost_entities, node_ghosts);
+    std::map<Color, std::size_t> layout;
+    for(const auto & [r, ee] : node_shared) {
+      layout[r] = node_total;
+      node_total += count(ee);
     }
-    max_local_source_idx += 1;
+    for(const auto & [r, first] : util::mpi::sparse_all_to_allv(layout))
+      node_sources.try_emplace(r, first);
+    node_size = node_total;
+    util::mpi::test(MPI_Allreduce(MPI_IN_PLACE,
+      &node_size,
+      1,
+      util::mpi::type<std::size_t>(),
+      MPI_MAX,
+      node));
+
+    buffers.resize(ghost_entities.size() + shared_entities.size() + 1);
+#if defined(FLECSI_ENABLE_KOKKOS)
+    for(auto k = buffers.size(); k--;)
+      device_buffers.emplace_back();
+#endif
   }
 
   // called with each field (and field_id_t) on the entity, for example, one
@@ -541,16 +912,70 @@ struct copy_engine {
   void operator()(field_id_t data_fid) const {
     using util::mpi::test;
 
+    auto type_size = source.r->get_field_info(data_fid)->type_size;
+    const Color n = source.r->local_rows(), s0 = source.r->color(0),
+                d0 = destination.r->color(0);
+
+    // The values in each row and whether they must be accessed in the
+    // execution space.
+    std::vector<std::pair<std::byte *, bool>> sources, destinations;
+#if defined(FLECSI_ENABLE_KOKKOS)
+    const auto where = [](mpi::detail::view_variant v) {
+      return std::visit(
+        [](auto & x) {
+          return std::pair<std::byte *, bool>(x.data(),
+            !mpi::detail::host_accessible &&
+              std::is_same_v<std::decay_t<decltype(x)>,
+                mpi::detail::device_view>);
+        },
+        v);
+    };
+#endif
+    // The storage is counted in bytes; it may not yet have been allocated
+    // (e.g., after a partition has grown).
+    // The source and destination are usually the same field, so growing one
+    // may move the other; the second request for the destination cannot.
+    for(Color i = 0; i < n; ++i) {
 #if defined(FLECSI_ENABLE_KOKKOS)
-    auto source_view = source.r->kokkos_view(data_fid);
-    auto destination_view = destination.kokkos_view(data_fid);
+      auto d = destination.kokkos_view(data_fid, i, type_size);
+      const auto s = source.r->kokkos_view(
+        data_fid, i, max_local_source_idx[i] * type_size);
+      if(source.r == destination.r)
+        d = destination.kokkos_view(data_fid, i, type_size);
+      sources.push_back(where(s));
+      destinations.push_back(where(d));
 #else
-    auto source_storage =
-      source.r->get_storage<std::byte>(data_fid, max_local_source_idx);
-    auto destination_storage = destination.get_storage<std::byte>(data_fid);
+      auto d = destination.get_storage<std::byte>(data_fid, i, type_size);
+      const auto s = source.r->get_storage<std::byte>(
+        data_fid, max_local_source_idx[i] * type_size, i);
+      if(source.r == destination.r)
+        d = destination.get_storage<std::byte>(data_fid, i, type_size);
+      sources.emplace_back(s.data(), false);
+      destinations.emplace_back(d.data(), false);
 #endif
+    }
 
-    auto type_size = source.r->get_field_info(data_fid)->type_size;
+    const auto all = [](const auto & rows, bool device) {
+      return std::all_of(rows.begin(), rows.end(), [device](const auto & r) {
+        return r.second == device;
+      });
+    };
+    // Whether any row is in execution-space memory, and whether messages can
+    // be packed and unpacked there and handed directly to MPI.
+    [[maybe_unused]] const bool device =
+      !all(sources, false) || !all(destinations, false);
+    bool direct = false;
+#if defined(FLECSI_ENABLE_KOKKOS)
+    direct = all(sources, true) && all(destinations, true) &&
+             mpi::detail::mpi_accessible();
+#endif
+
+    // Grow a reused buffer to at least n bytes.
+    const auto reserve = [](auto & b, std::size_t n) {
+      if(b.size() < n)
+        b.resize(n);
+      return b.data();
+    };
 
     auto gather_copy = [type_size](std::byte * dst,
                          const std::byte * src,
@@ -570,31 +995,94 @@ struct copy_engine {
       }
     };
 
+    // Copy the shared values of the local row i to offset off in the host
+    // buffer h or, if they are in execution-space memory, in the buffer d
+    // (and then h unless it is null, as for a direct copy).
+    auto gather = [&](std::byte * h,
+                    [[maybe_unused]] std::byte * d,
+                    std::size_t off,
+                    Color i,
+                    const std::vector<std::size_t> & shared_indices) {
+      const auto [src, on_device] = sources[i];
+      if(!on_device) {
+        gather_copy(h + off, src, shared_indices);
+        return;
+      }
 #if defined(FLECSI_ENABLE_KOKKOS)
-    // copy a std::vector<T> from host to device memory and return the device
-    // version as a Kokkos::View
-    auto device_copy = [](const auto & hvec, const std::string & label) {
-      using T = typename std::decay_t<decltype(hvec)>::value_type;
-      Kokkos::View<T *, Kokkos::DefaultExecutionSpace> dview{
-        Kokkos::ViewAllocateWithoutInitializing(label), hvec.size()};
-      Kokkos::deep_copy(Kokkos::DefaultExecutionSpace{},
-        dview,
-        Kokkos::View<const T *, Kokkos::HostSpace>{hvec.data(), hvec.size()});
-      return dview;
+      const std::size_t n_bytes = shared_indices.size() * type_size;
+      mpi::detail::device_copy(d + off,
+        nullptr,
+        src,
+        device_indices(shared_indices),
+        shared_indices.size(),
+        type_size);
+      if(h)
+        Kokkos::deep_copy(mpi::detail::host_view{h + off, n_bytes},
+          mpi::detail::device_const_view{d + off, n_bytes});
+#endif
     };
+
+    // Copy ghost values to the local row i from offset off in the host buffer
+    // h or, if they belong in execution-space memory, in the buffer d (after
+    // copying them there from h unless it is null).
+    auto scatter = [&](Color i,
+                     const std::byte * h,
+                     [[maybe_unused]] std::byte * d,
+                     std::size_t off,
+                     const std::vector<std::size_t> & ghost_indices) {
+      const auto [dst, on_device] = destinations[i];
+      if(!on_device) {
+        scatter_copy(dst, h + off, ghost_indices);
+        return;
+      }
+#if defined(FLECSI_ENABLE_KOKKOS)
+      const std::size_t n_bytes = ghost_indices.size() * type_size;
+      if(h)
+        Kokkos::deep_copy(mpi::detail::device_view{d + off, n_bytes},
+          mpi::detail::host_const_view{h + off, n_bytes});
+      mpi::detail::device_copy(dst,
+        device_indices(ghost_indices),
+        d + off,
+        nullptr,
+        ghost_indices.size(),
+        type_size);
+#endif
+    };
+
+    // Return the reused host and execution-space buffers with index k,
+    // allocating only those that will be used.
+    const auto buffer = [&](std::size_t k, std::size_t n_bytes) {
+      std::pair<std::byte *, std::byte *> ret{
+        direct ? nullptr : reserve(buffers[k], n_bytes), nullptr};
+#if defined(FLECSI_ENABLE_KOKKOS)
+      if(device)
+        ret.second = reserve(device_buffers[k], n_bytes);
 #endif
+      return ret;
+    };
 
-    std::vector<std::vector<std::byte>> recv_buffers;
+    // Return the reused execution-space buffer for staging, if needed.
+    const auto staging = [&]([[maybe_unused]] std::size_t n_bytes)
+      -> std::byte * {
+#if defined(FLECSI_ENABLE_KOKKOS)
+      if(device)
+        return reserve(device_buffers.back(), n_bytes);
+#endif
+      return nullptr;
+    };
 
+    // Buffers are numbered by the messages received, then those sent, then
+    // the one for copies between rows on this rank.
+    std::size_t k = 0;
     {
-      std::vector<std::vector<std::byte>> send_buffers;
       util::mpi::auto_requests requests(
         ghost_entities.size() + shared_entities.size());
 
-      for(const auto & [src_rank, ghost_indices] : ghost_entities) {
-        recv_buffers.emplace_back(ghost_indices.size() * type_size);
-        test(MPI_Irecv(recv_buffers.back().data(),
-          int(recv_buffers.back().size()),
+      for(const auto & [src_rank, ee] : ghost_entities) {
+        const std::size_t n_bytes = count(ee) * type_size;
+        const auto [h, d] = buffer(k++, n_bytes);
+        test(MPI_Irecv(direct ? d : h,
+          int(n_bytes),
           MPI_BYTE,
           int(src_rank),
           0,
@@ -602,111 +1090,205 @@ struct copy_engine {
           requests()));
       }
 
-      for(const auto & [dst_rank, shared_indices] : shared_entities) {
-        auto n_elements = shared_indices.size();
-        auto n_bytes = n_elements * type_size;
-        send_buffers.emplace_back(n_bytes);
-
+      // Both sides of a message order the pairs of colors in the same way.
+      std::size_t sent = 0;
+      for(const auto & [dst_rank, ee] : shared_entities) {
+        const std::size_t n_bytes = count(ee) * type_size;
+        const auto [h, d] = buffer(k++, n_bytes);
+        sent += n_bytes;
+        std::size_t off = 0;
+        for(const auto & [e, shared_indices] : ee) {
+          gather(h, d, off, e.first - s0, shared_indices);
+          off += shared_indices.size() * type_size;
+        }
 #if defined(FLECSI_ENABLE_KOKKOS)
-        // We can not capture shared_indices in the overloaded lambda inside
-        // std::visit directly
-        const auto & src_indices = shared_indices;
-        std::visit(
-          overloaded{[&](mpi::detail::host_view & src) {
-                       gather_copy(
-                         send_buffers.back().data(), src.data(), src_indices);
-                     },
-            [&](mpi::detail::device_view & src) {
-              // copy shared indices from host to device
-              auto shared_indices_device_view =
-                device_copy(src_indices, "shared indices");
-
-              // allocate gather buffer on device
-              auto gather_buffer_device_view =
-                Kokkos::View<std::byte *, Kokkos::DefaultExecutionSpace>{
-                  "gather", n_bytes};
-
-              // copy shared values to gather buffer on device in parallel, for
-              // each element
-              Kokkos::parallel_for(
-                n_elements, KOKKOS_LAMBDA(const auto & i) {
-                  // Yes, memcpy is supported on device as long as there is no
-                  // std:: qualifier.
-                  memcpy(gather_buffer_device_view.data() + i * type_size,
-                    src.data() + shared_indices_device_view[i] * type_size,
-                    type_size);
-                });
-
-              // copy gathered shared values to send_buffer on host to be sent
-              // through MPI.
-              Kokkos::deep_copy(Kokkos::DefaultExecutionSpace{},
-                mpi::detail::host_view{send_buffers.back().data(), n_bytes},
-                gather_buffer_device_view);
-            }},
-          source_view);
-#else
-        gather_copy(
-          send_buffers.back().data(), source_storage.data(), shared_indices);
+        if(direct)
+          Kokkos::DefaultExecutionSpace{}.fence();
 #endif
 
-        test(MPI_Isend(send_buffers.back().data(),
-          int(send_buffers.back().size()),
+        test(MPI_Isend(direct ? d : h,
+          int(n_bytes),
           MPI_BYTE,
           int(dst_rank),
           0,
           MPI_COMM_WORLD,
           requests()));
       }
+      util::profile::traffic(sent, shared_entities.size());
+
+      // Pack the values for this node into alternate halves of our segment,
+      // which every copy engine shares, once the peers that read that half
+      // last have said so.  Each peer is then told that its values are ready.
+      auto & ctx = run::context::instance();
+      const MPI_Comm node = ctx.node();
+      run::context_t::node_window * w = nullptr;
+      std::size_t half = 0;
+      if(node_size) {
+        w = &ctx.window(type_size, 2 * node_size * type_size);
+        half = w->memory.size() / 2;
+        auto & pending = w->pending[w->parity];
+        pending = {};
+        w->memory.sync();
+        std::byte * const mine = w->memory.data() + w->parity * half;
+        std::byte * const d = staging(node_total * type_size);
+        std::size_t off = 0;
+        for(const auto & [dst_rank, ee] : node_shared)
+          for(const auto & [e, shared_indices] : ee) {
+            gather(mine, d, off, e.first - s0, shared_indices);
+            off += shared_indices.size() * type_size;
+          }
+        w->memory.sync();
+        for(const auto & [dst_rank, ee] : node_shared) {
+          const int r = node_rank.at(dst_rank);
+          test(MPI_Isend(nullptr, 0, MPI_BYTE, r, 0, node, pending()));
+          test(MPI_Irecv(nullptr, 0, MPI_BYTE, r, 1, node, pending()));
+        }
+      }
+
+      // Copy between rows on this rank while the messages are in flight.
+      // Ghost and shared entities are disjoint, so no copy affects another.
+      for(const auto & [e, shared_indices] : local_entities) {
+        const auto & ghost_indices = local_ghosts.at(e);
+        const auto [src, from_device] = sources[e.first - s0];
+        const auto [dst, to_device] = destinations[e.second - d0];
+        if(!from_device && !to_device)
+          for(std::size_t i = 0; i < ghost_indices.size(); ++i)
+            std::memcpy(dst + ghost_indices[i] * type_size,
+              src + shared_indices[i] * type_size,
+              type_size);
+#if defined(FLECSI_ENABLE_KOKKOS)
+        else if(from_device && to_device)
+          mpi::detail::device_copy(dst,
+            device_indices(ghost_indices),
+            src,
+            device_indices(shared_indices),
+            ghost_indices.size(),
+            type_size);
+        else {
+          const auto [h, d] = buffer(k, ghost_indices.size() * type_size);
+          gather(h, d, 0, e.first - s0, shared_indices);
+          scatter(e.second - d0, h, d, 0, ghost_indices);
+        }
+#endif
+      }
+
+      // Read the values from the peers on this node, and tell them so.
+      if(w) {
+        {
+          util::mpi::auto_requests ready(node_ghosts.size());
+          for(const auto & [src_rank, ee] : node_ghosts)
+            test(MPI_Irecv(
+              nullptr, 0, MPI_BYTE, node_rank.at(src_rank), 0, node, ready()));
+        }
+        w->memory.sync();
+        for(const auto & [src_rank, ee] : node_ghosts) {
+          const std::byte * const h =
+            w->memory.segment(node_rank.at(src_rank)) + w->parity * half +
+            node_sources.at(src_rank) * type_size;
+          std::byte * const d = staging(count(ee) * type_size);
+          std::size_t off = 0;
+          for(const auto & [e, ghost_indices] : ee) {
+            scatter(e.second - d0, h, d, off, ghost_indices);
+            off += ghost_indices.size() * type_size;
+          }
+        }
+        w->memory.sync();
+        auto & pending = w->pending[w->parity];
+        for(const auto & [src_rank, ee] : node_ghosts)
+          test(MPI_Isend(
+            nullptr, 0, MPI_BYTE, node_rank.at(src_rank), 1, node, pending()));
+        w->parity = !w->parity;
+      }
     }
 
-    // copy from intermediate receive buffer to destination storage
-    auto recv_buffer = recv_buffers.begin();
-    for(const auto & [src_rank, ghost_indices] : ghost_entities) {
+    // copy from the receive buffers to destination storage
+    k = 0;
+    for(const auto & [src_rank, ee] : ghost_entities) {
+      // A direct message was received into d; h may hold an old one.
+      const std::byte * h = direct ? nullptr : buffers[k].data();
+      std::byte * d = nullptr;
 #if defined(FLECSI_ENABLE_KOKKOS)
-      auto n_elements = ghost_indices.size();
-      // We can not capture ghost_indices in the overloaded lambda inside
-      // std::visit directly
-      const auto & dst_indices = ghost_indices;
-      std::visit(
-        overloaded{[&](mpi::detail::host_view & dst) {
-                     scatter_copy(dst.data(), recv_buffer->data(), dst_indices);
-                   },
-          [&](mpi::detail::device_view & dst) {
-            // copy ghost indices from host to device
-            auto ghost_indices_device_view =
-              device_copy(dst_indices, "ghost indices");
-
-            // copy recv buffer from host to scatter buffer on device
-            auto scatter_buffer_device_view =
-              device_copy(*recv_buffer, "scatter");
-
-            // copy ghost values from scatter buffer on device to field storage
-            // in parallel, for each element
-            Kokkos::parallel_for(
-              n_elements, KOKKOS_LAMBDA(const auto & i) {
-                memcpy(dst.data() + ghost_indices_device_view[i] * type_size,
-                  scatter_buffer_device_view.data() + i * type_size,
-                  type_size);
-              });
-          }},
-        destination_view);
-#else
-      scatter_copy(
-        destination_storage.data(), recv_buffer->data(), ghost_indices);
+      if(device)
+        d = device_buffers[k].data();
 #endif
-      recv_buffer++;
+      std::size_t off = 0;
+      for(const auto & [e, ghost_indices] : ee) {
+        scatter(e.second - d0, h, d, off, ghost_indices);
+        off += ghost_indices.size() * type_size;
+      }
+      ++k;
+    }
+#if defined(FLECSI_ENABLE_KOKKOS)
+    // The buffers may be reused as soon as this function is called again.
+    if(device)
+      Kokkos::DefaultExecutionSpace{}.fence();
+    // Only the ghosts of the copies written differ from the other copies.
+    for(Color i = 0; i < n; ++i) {
+      std::vector<std::pair<std::size_t, std::size_t>> bytes;
+      for(const auto & [b, e] : destination.ghost_ranges[i])
+        bytes.emplace_back(b * type_size, e * type_size);
+      destination.r->modified(data_fid, i, bytes);
     }
+#endif
   }
 
 private:
-  // (remote rank, { local indices })
-  using SendPoints = std::map<Color, std::vector<std::size_t>>;
+  // (source color, destination color)
+  using Edge = std::pair<Color, Color>;
+  // (pair of colors, { indices in one of them })
+  using Edges = std::map<Edge, std::vector<std::size_t>>;
+  // (remote rank, ...)
+  using SendPoints = std::map<Color, Edges>;
+
+  static std::size_t count(const Edges & ee) {
+    std::size_t ret = 0;
+    for(const auto & [e, indices] : ee)
+      ret += indices.size();
+    return ret;
+  }
+
+#if defined(FLECSI_ENABLE_KOKKOS)
+  // Return a copy of an index list in execution-space memory, made on first
+  // use; the lists do not change after construction.
+  const std::size_t * device_indices(
+    const std::vector<std::size_t> & v) const {
+    auto [i, fresh] = index_views.try_emplace(&v);
+    if(fresh) {
+      const std::size_t n_bytes = v.size() * sizeof(std::size_t);
+      i->second.resize(std::max(n_bytes, sizeof(std::size_t)));
+      Kokkos::deep_copy(mpi::detail::device_view{i->second.data(), n_bytes},
+        mpi::detail::host_const_view{
+          reinterpret_cast<const std::byte *>(v.data()), n_bytes});
+    }
+    return reinterpret_cast<const std::size_t *>(i->second.data());
+  }
+#endif
 
   const points & source;
   const intervals & destination;
-  SendPoints ghost_entities; // (src rank,  { local ghost indices})
-  SendPoints shared_entities; // (dest rank, { local shared indices})
-  std::size_t max_local_source_idx = 0;
+  SendPoints ghost_entities; // (src rank, {local ghost indices})
+  SendPoints shared_entities; // (dest rank, {local shared indices})
+  Edges local_entities, local_ghosts; // for pairs of colors on this rank
+  std::vector<std::size_t> max_local_source_idx; // for each local row
+
+  // The peers on this node, which are not in ghost_entities and
+  // shared_entities, and the rank in context_t::node of each process on it.
+  SendPoints node_ghosts, node_shared;
+  std::map<Color, int> node_rank;
+  // For each peer in node_ghosts, the offset of our values in its segment, in
+  // elements.
+  std::map<Color, std::size_t> node_sources;
+  std::size_t node_total = 0; // elements in our segment
+  std::size_t node_size; // the largest node_total on this node
+
+  // Message buffers, reused by every call and only ever grown.
+  mutable std::vector<std::vector<std::byte>> buffers;
+#if defined(FLECSI_ENABLE_KOKKOS)
+  mutable std::deque<mpi::detail::buffer_impl_toc> device_buffers;
+  mutable std::map<const std::vector<std::size_t> *,
+    mpi::detail::buffer_impl_toc>
+    index_views;
+#endif
 };
 
 } // namespace data
@@ -5,7 +5,10 @@
 #define FLECSI_EXEC_FOLD_HH
 
 #include <algorithm>
+#include <cstddef>
 #include <limits>
+#include <tuple>
+#include <utility>
 
 #include "flecsi/util/target.hh"
 
@@ -94,6 +97,45 @@ struct product {
   static constexpr T identity = T(1);
 }; // struct product
 
+/*!
+  Elementwise reduction over a tuple-like type with one component per
+  reduction type.  Several values can thus be reduced with a single
+  collective operation, as with
+  \code
+  reduce<task, exec::fold::tuple<exec::fold::sum, exec::fold::max>>(...)
+  \endcode
+  for a \c task that returns `std::tuple<double, double>`.
+  This class is supported for GPU execution if each \a RR is.
+  \tparam RR reduction types
+ */
+template<class... RR>
+struct tuple {
+  template<class T>
+  FLECSI_INLINE_TARGET static T combine(T a, const T & b) {
+    return combine(std::move(a), b, std::index_sequence_for<RR...>());
+  }
+
+private:
+  template<class T, std::size_t... II>
+  FLECSI_INLINE_TARGET static T
+  combine(T a, const T & b, std::index_sequence<II...>) {
+    static_assert(std::tuple_size_v<T> == sizeof...(RR),
+      "one reduction type is needed for each component");
+    ((std::get<II>(a) = RR::combine(std::get<II>(a), std::get<II>(b))), ...);
+    return a;
+  }
+
+  template<class T, std::size_t... II>
+  static constexpr T make_identity(std::index_sequence<II...>) {
+    return {RR::template identity<std::tuple_element_t<II, T>>...};
+  }
+
+public:
+  template<class T>
+  static constexpr T identity =
+    make_identity<T>(std::index_sequence_for<RR...>());
+}; // struct tuple
+
 /// \}
 } // namespace exec::fold
 
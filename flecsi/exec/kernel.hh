@@ -4,7 +4,9 @@
 #ifndef FLECSI_EXEC_KERNEL_HH
 #define FLECSI_EXEC_KERNEL_HH
 
+#include <array>
 #include <numeric>
+#include <utility>
 
 #include "flecsi/exec/fold.hh"
 
@@ -251,6 +253,117 @@ mdiota_view(const M & m, RR... rr) {
     m, std::index_sequence_for<RR...>(), std::make_tuple(rr...));
 }
 
+struct tile_tag {};
+
+/// The Cartesian product of several intervals of integers, visited in blocks
+/// (tiles) so that a stencil reuses the neighbors it loads from cache.
+/// Within each tile, and among the tiles, the least significant index varies
+/// fastest.  Use \c mdtiles to construct one.
+/// \tparam D dimension
+template<Dimension D>
+struct tiled_range : tile_tag {
+  using index = std::array<range_index, D>;
+
+  /// intervals, least significant first
+  std::array<sub_range, D> range;
+  /// tile sizes, least significant first
+  index tile;
+
+  /// Call a function with each index in tiled order.
+  template<class F>
+  void for_each(F && f) const {
+    index b, e, x;
+    for(Dimension d = 0; d < D; ++d)
+      if(!range[d].size())
+        return;
+      else
+        b[d] = range[d].beg;
+    for(;;) {
+      for(Dimension d = 0; d < D; ++d)
+        e[d] = std::min(b[d] + tile[d], range[d].end);
+      x = b;
+      for(;;) {
+        for(x[0] = b[0]; x[0] < e[0]; ++x[0])
+          f(std::as_const(x));
+        Dimension d = 1;
+        for(; d < D && ++x[d] == e[d]; ++d)
+          x[d] = b[d];
+        if(d == D)
+          break;
+      }
+      Dimension d = 0;
+      for(; d < D && (b[d] += tile[d]) >= range[d].end; ++d)
+        b[d] = range[d].beg;
+      if(d == D)
+        break;
+    }
+  }
+
+#if defined(FLECSI_ENABLE_KOKKOS)
+  auto get_policy() const {
+    static_assert(D <= 6, "Kokkos supports tiling at most 6 dimensions");
+    using P = Kokkos::MDRangePolicy<
+      Kokkos::Rank<D, Kokkos::Iterate::Left, Kokkos::Iterate::Left>,
+      Kokkos::IndexType<util::id>>;
+    typename P::point_type lo, hi;
+    typename P::tile_type t;
+    for(Dimension d = 0; d < D; ++d) {
+      lo[d] = range[d].beg;
+      hi[d] = range[d].end;
+      t[d] = tile[d];
+    }
+    return P(lo, hi, t);
+  }
+
+  // Adapt a function of an index to the per-dimension arguments Kokkos
+  // passes, optionally followed by a reduction variable.
+  template<class... TT, class F>
+  static auto functor(F f) {
+    return functor<TT...>(std::move(f), std::make_index_sequence<D>());
+  }
+
+private:
+  template<class... TT, class F, std::size_t... II>
+  static auto functor(F f, std::index_sequence<II...>) {
+    return [f] FLECSI_TARGET(
+             decltype((void)II, util::id())... ii, TT &... tt) {
+      f(index{range_index(ii)...}, tt...);
+    };
+  }
+#endif
+};
+
+/// Visit the Cartesian product of several intervals of integers in tiles.
+/// The indices are as for \c mdiota_view, but are visited one tile at a time
+/// with the least significant index varying fastest.  Pass the result
+/// directly to \c forall or \c reduceall (rather than wrapping it in another
+/// policy).
+/// \param m mdspan or mdcolex object
+/// \param t tile size for each dimension (least significant first); for
+///   stencils on large colors, tiles should span the least significant
+///   dimension and be a few planes in the others
+/// \param rr \c full_range, \c prefix_range, or \c sub_range objects for each
+///   dimension
+/// \return \c tiled_range
+template<class M, class... RR>
+auto
+mdtiles(const M & m,
+  const std::array<range_index, sizeof...(RR)> & t,
+  RR... rr) {
+  constexpr auto D = sizeof...(RR);
+  tiled_range<D> ret;
+  Dimension d = 0;
+  (
+    [&](const auto & r) {
+      const range_index b = r.start();
+      ret.range[d] = {b, range_index(b + r.size())};
+      ret.tile[d] = t[d] ? t[d] : 1;
+      ++d;
+    }(rr.get(m.length(d))),
+    ...);
+  return ret;
+}
+
 /// This function is a wrapper for Kokkos::parallel_for that has been adapted to
 /// work with random access ranges common in FleCSI topologies. In particular,
 /// this function invokes a map from the normal kernel index space to the FleCSI
@@ -259,7 +372,18 @@ mdiota_view(const M & m, RR... rr) {
 template<typename Policy, typename Lambda>
 void
 parallel_for(Policy && p, Lambda && lambda, const std::string & name = "") {
-  if constexpr(std::is_base_of_v<policy_tag, std::remove_reference_t<Policy>>) {
+  if constexpr(std::is_base_of_v<tile_tag, std::remove_reference_t<Policy>>) {
+#if defined(FLECSI_ENABLE_KOKKOS)
+    using T = std::remove_reference_t<Policy>;
+    Kokkos::parallel_for(
+      name, p.get_policy(), T::functor(std::forward<Lambda>(lambda)));
+#else
+    (void)name;
+    p.for_each(lambda);
+#endif
+  }
+  else if constexpr(std::is_base_of_v<policy_tag,
+                      std::remove_reference_t<Policy>>) {
     auto policy_type = p.get_policy(); // before moving
 #if defined(FLECSI_ENABLE_KOKKOS)
     Kokkos::parallel_for(name,
@@ -320,9 +444,28 @@ struct reduce_ref {
 template<class R, class T, typename Policy, typename Lambda>
 T
 parallel_reduce(Policy && p, Lambda && lambda, const std::string & name = "") {
-  if constexpr(std::is_base_of_v<policy_tag, std::remove_reference_t<Policy>>) {
+  using ref = detail::reduce_ref<R, T>;
+  if constexpr(std::is_base_of_v<tile_tag, std::remove_reference_t<Policy>>) {
+#if defined(FLECSI_ENABLE_KOKKOS)
+    kok::wrap<R, T> result;
+    Kokkos::parallel_reduce(name,
+      p.get_policy(),
+      std::remove_reference_t<Policy>::template functor<T>(
+        [f = std::forward<Lambda>(lambda)] FLECSI_TARGET(
+          const auto & i, T & tmp) { f(i, ref{tmp}); }),
+      result.kokkos());
+    return result.reference();
+#else
+    (void)name;
+    T res = detail::identity_traits<R>::template value<T>;
+    ref r{res};
+    p.for_each([&](const auto & i) { lambda(i, r); });
+    return res;
+#endif
+  }
+  else if constexpr(std::is_base_of_v<policy_tag,
+                      std::remove_reference_t<Policy>>) {
     auto policy_type = p.get_policy(); // before moving
-    using ref = detail::reduce_ref<R, T>;
 #if defined(FLECSI_ENABLE_KOKKOS)
     kok::wrap<R, T> result;
     Kokkos::parallel_reduce(
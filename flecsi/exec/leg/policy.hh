@@ -148,6 +148,8 @@ reduce_internal(Args &&... args) {
       default:
         break;
     }
+    if constexpr((Attributes & balanced) != 0)
+      l.tag |= run::mapper::balance;
   };
 
   if constexpr(std::is_same_v<decltype(domain_size), const std::monostate>) {
@@ -56,15 +56,18 @@ template<typename R>
 struct future<R, exec::launch_type_t::index> {
   using result_type = std::conditional_t<std::is_same_v<R, bool>, char, R>;
 
-  explicit future(R r) : result(std::move(r)) {
-    results.resize(size());
+  explicit future(R r) : future(std::vector<result_type>(1, std::move(r))) {}
+  // Each process supplies the same number of results, in order of color.
+  explicit future(std::vector<result_type> rr) : locals(std::move(rr)) {
+    const int n = locals.size();
+    results.resize(n * run::context::instance().processes());
 
     // Initiate MPI_Iallgather
-    util::mpi::test(MPI_Iallgather(&result,
-      1,
+    util::mpi::test(MPI_Iallgather(locals.data(),
+      n,
       flecsi::util::mpi::type<result_type>(),
       results.data(),
-      1,
+      n,
       flecsi::util::mpi::type<result_type>(),
       MPI_COMM_WORLD,
       request()));
@@ -82,13 +85,16 @@ struct future<R, exec::launch_type_t::index> {
   }
 
   Color size() const {
-    return run::context::instance().processes();
+    return results.size();
   }
 
-  result_type result;
+  // The result for the current color, which is held by this process.
+  const result_type & local() const {
+    return locals[run::context_t::local_color()];
+  }
 
 private:
-  std::vector<result_type> results;
+  std::vector<result_type> locals, results;
   util::mpi::auto_requests request;
 };
 
@@ -97,8 +103,10 @@ struct future<void, exec::launch_type_t::index> {
   void wait(bool = false) {}
   void get(Color = 0, bool = false) {}
   Color size() const {
-    return run::context::instance().processes();
+    return n;
   }
+
+  Color n = run::context::instance().processes();
 };
 } // namespace flecsi
 
@@ -11,12 +11,19 @@
 #include "flecsi/exec/mpi/tracer.hh"
 #include "flecsi/exec/prolog.hh"
 #include "flecsi/flog.hh"
+#include "flecsi/run/options.hh"
+#include "flecsi/run/types.hh"
 #include "flecsi/util/function_traits.hh"
+#include "flecsi/util/pool.hh"
 
 #include <mpi.h>
 
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <type_traits>
 #include <utility> // forward
+#include <vector>
 
 namespace flecsi {
 namespace exec {
@@ -24,7 +31,31 @@ namespace exec {
 /// Direct task execution.
 /// \ingroup execution
 /// \{
+
+/// Number of host threads used to execute the point tasks of an index launch
+/// that are held by the same process.
+inline program_option<int> task_threads_option("FleCSI Options",
+  "task-threads",
+  "Number of host threads used to execute the point tasks of an index launch "
+  "held by the same process (when there are several colors per process).",
+  {{flecsi::option_default, 1}},
+  [](int n, std::stringstream & ss) {
+    return n > 0 || ((ss << "task-threads must be positive"), false);
+  });
+
 namespace detail {
+// The threads for point tasks, or null if there is to be only one.  The pool
+// cannot serve nested or concurrent launches, so it is used only by the owner
+// of task_pool_mutex.
+inline std::mutex task_pool_mutex;
+inline util::thread_pool *
+task_pool() {
+  static const std::unique_ptr<util::thread_pool> ret = [] {
+    const int n = task_threads_option.value();
+    return n > 1 ? std::make_unique<util::thread_pool>(n) : nullptr;
+  }();
+  return ret.get();
+}
 
 // AA is what the user gives us when calling execute(), PP is what
 // the user defined function/task expects. PP may not be the same
@@ -42,6 +73,105 @@ replace_arguments(std::tuple<PP...> * /* to deduce PP */, AA &&... aa) {
     aa)))...>(exec::replace_argument<PP>(std::forward<AA>(aa))...);
 }
 
+// Execute the point tasks of an index launch of size n held by this process
+// (which must be more than one), perhaps concurrently.
+template<auto & F, class Reduction, TaskAttributes Attributes, typename... Args>
+auto
+launch_local(Color n, Args &... args) {
+  using util::mpi::test;
+  using Traits = util::function_t<F>;
+  using R = typename Traits::return_type;
+  using context = run::context_t;
+  constexpr auto processor = mask_to_processor_type(Attributes);
+
+  const auto [first, k] = run::context::instance().local_colors(n);
+  const auto task_name = util::symbol<F>();
+  const auto point = [&, first = first](Color i) {
+    return context::color_guard(first + i, n, i);
+  };
+
+  // Each point task has its own parameters, which are prepared in order as
+  // for a single color; the first prolog performs all the ghost copies.
+  using Params = decltype(replace_arguments(
+    static_cast<typename Traits::arguments_type *>(nullptr), args...));
+  using Buffers = decltype(exec::param_buffers(
+    std::declval<Params &>(), std::declval<const std::string &>()));
+  std::deque<Params> params;
+  std::deque<Buffers> finalize;
+  std::deque<run::task_local_base::guard> locals;
+  for(Color i = 0; i < k; ++i) {
+    const auto cg = point(i);
+    auto & p = params.emplace_back(replace_arguments(
+      static_cast<typename Traits::arguments_type *>(nullptr), args...));
+    finalize.emplace_back(p, task_name);
+    {
+      const prolog<processor> pr(p, args...);
+    }
+    context::depth_guard rg;
+    locals.emplace_back();
+  }
+
+  // As for future<R, index>, which doesn't exist for void:
+  using Result =
+    std::conditional_t<std::is_void_v<R> || std::is_same_v<R, bool>, char, R>;
+  std::vector<Result> results(k);
+  {
+    util::annotation::rguard<util::annotation::execute_task_user> ann{
+      task_name};
+    const auto task = [&](std::size_t i) {
+      const auto cg = point(i);
+      context::depth_guard rg;
+      if constexpr(std::is_void_v<R>)
+        std::apply(F, std::move(params[i]));
+      else
+        results[i] = std::apply(F, std::move(params[i]));
+    };
+    std::unique_lock lock(task_pool_mutex, std::try_to_lock);
+    if(auto * const pool = task_pool();
+       pool && lock && processor != task_processor_type_t::toc &&
+       !context::task_depth())
+      (*pool)(k, task);
+    else
+      for(Color i = 0; i < k; ++i)
+        task(i);
+  }
+
+  for(Color i = 0; i < k; ++i) {
+    const auto cg = point(i);
+    {
+      context::depth_guard rg;
+      locals.pop_front();
+    }
+    finalize.pop_front();
+  }
+
+  if constexpr(!std::is_void_v<Reduction>) {
+    static_assert(!std::is_void_v<R>, "can not reduce results of void task");
+    // Reduce the local results first.
+    auto ret = future<R>::make(
+      [&] {
+        R r = results.front();
+        for(std::size_t i = 1; i < results.size(); ++i)
+          r = Reduction::combine(std::move(r), R(results[i]));
+        return r;
+      },
+      true);
+    test(MPI_Iallreduce(MPI_IN_PLACE,
+      ret->data(),
+      1,
+      flecsi::util::mpi::type<R>(),
+      flecsi::exec::fold::wrap<Reduction, R>::op,
+      MPI_COMM_WORLD,
+      ret->request()));
+    ret->measure("execute_task->reduction", task_name);
+    return ret;
+  }
+  else if constexpr(!std::is_void_v<R>)
+    return future<R, exec::launch_type_t::index>(std::move(results));
+  else
+    return future<void, exec::launch_type_t::index>{n};
+}
+
 } // namespace detail
 
 template<auto & F, class Reduction, TaskAttributes Attributes, typename... Args>
@@ -51,6 +181,26 @@ reduce_internal(Args &&... args) {
   using Traits = util::function_t<F>;
   using R = typename Traits::return_type;
 
+  run_impl::launch_turn();
+
+  // Determine the launch size before preparing the parameters, which differ
+  // if there are several colors on each process.
+  const auto ds = launch_size<Attributes,
+    decltype(exec::detail::replace_arguments(
+      static_cast<typename Traits::arguments_type *>(nullptr),
+      std::forward<Args>(args)...))>(args...);
+  if constexpr(!std::is_same_v<decltype(ds), const std::monostate> &&
+               mask_to_processor_type(Attributes) !=
+                 task_processor_type_t::mpi) {
+    auto & ctx = run::context::instance();
+    if(ds != ctx.processes()) {
+      flog_assert(ctx.local_colors(ds).second > 1,
+        "MPI backend supports only index launches over a multiple of the "
+        "number of processes");
+      return detail::launch_local<F, Reduction, Attributes>(ds, args...);
+    }
+  }
+
   // replace arguments in args, for example, field_reference -> accessor.
   auto params = exec::detail::replace_arguments(
     static_cast<typename Traits::arguments_type *>(nullptr),
@@ -92,7 +242,6 @@ reduce_internal(Args &&... args) {
   //    index>.get(j) to get the return value on any rank j. This implies an
   //    Allgather is needed.
   //
-  const auto ds = launch_size<Attributes, decltype(params)>(args...);
   const auto task = [&params] { return std::apply(F, std::move(params)); };
   util::annotation::rguard<util::annotation::execute_task_user> ann{task_name};
   if constexpr(std::is_same_v<decltype(ds), const std::monostate>) {
@@ -122,7 +271,7 @@ reduce_internal(Args &&... args) {
   }
   else {
     flog_assert(ds == run::context::instance().processes(),
-      "MPI backend supports only per-rank index launches");
+      "MPI tasks must be launched over the processes");
     // index launch (including "mpi task"), invoke the user task on all ranks.
     if constexpr(!std::is_void_v<Reduction>) {
       static_assert(!std::is_void_v<R>, "can not reduce results of void task");
@@ -141,6 +290,7 @@ reduce_internal(Args &&... args) {
         flecsi::exec::fold::wrap<Reduction, R>::op,
         MPI_COMM_WORLD,
         ret->request()));
+      ret->measure("execute_task->reduction", task_name);
 
       return ret;
     }
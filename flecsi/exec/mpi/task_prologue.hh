@@ -34,7 +34,7 @@ protected:
   template<typename R>
   static void visit(future<R, exec::launch_type_t::single> & single,
     const future<R, exec::launch_type_t::index> & index) {
-    single = future<R>::make(index.result);
+    single = future<R>::make(index.local());
   }
 
   // Note: due to how visitor() is implemented in prolog.hh the first
@@ -58,26 +58,35 @@ protected:
       std::is_same_v<typename Topo::base, topo::global_base>;
 
     // Perform ghost copy using host side storage. This might copy data
-    // from the device side first.
-    if constexpr(glob) {
-      if(reg.ghost<privilege_pack<get_privilege(0, P), ro>>(f)) {
-        // This is a special case of ghost_copy thus we need the storage
-        // in HostSpace rather than ExecutionSpace.
-        auto host_storage = t->template get_storage<T>(f);
-        util::mpi::test(MPI_Bcast(host_storage.data(),
-          host_storage.size(),
-          flecsi::util::mpi::type<T>(),
-          0,
-          MPI_COMM_WORLD));
+    // from the device side first. The copy serves all the colors of an index
+    // launch held by this process.
+    if(!run::context_t::local_color()) {
+      if constexpr(glob) {
+        if(reg.ghost<privilege_pack<get_privilege(0, P), ro>>(f)) {
+          // This is a special case of ghost_copy thus we need the storage
+          // in HostSpace rather than ExecutionSpace.
+          auto host_storage = t->template get_storage<T>(f);
+          util::mpi::test(MPI_Bcast(host_storage.data(),
+            host_storage.size(),
+            flecsi::util::mpi::type<T>(),
+            0,
+            MPI_COMM_WORLD));
+        }
       }
+      else
+        reg.ghost_copy<P>(ref);
     }
-    else
-      reg.ghost_copy<P>(ref);
 
-    if(!get_selected(t))
+    const auto c = get_claim(t);
+    if(c == data::borrow::nil)
       return;
     // Now bind the ExecutionSpace storage to the accessor. This will also
-    // trigger a host <-> device copy if needed.
+    // trigger a host <-> device copy of whatever is stale there unless the
+    // task overwrites it. The storage is that of the selected color, which
+    // may be another one held by this process.
+    const run::context_t::color_guard cg(c,
+      run::context::instance().colors(),
+      run::context_t::local_color());
     const auto storage = [&]() -> auto & {
       if constexpr(glob)
         return *t;
@@ -85,7 +94,7 @@ protected:
         // The partition controls how much memory is allocated.
         return t.template get_partition<Space>();
     }
-    ().template get_storage<T, ProcessorType>(f);
+    ().template get_storage<T, ProcessorType, privilege_merge(P)>(f);
     accessor.bind(storage);
   } // visit generic topology
 
@@ -93,6 +102,10 @@ protected:
   void visit(data::reduction_accessor<R, T> & accessor,
     const data::field_reference<T, data::dense, Topo, Space> & ref) {
     static_assert(std::is_same_v<typename Topo::base, topo::global_base>);
+    flog_assert(run::context::instance().colors() ==
+                  run::context::instance().processes(),
+      "sorry: MPI backend supports reductions only with one color per "
+      "process");
     const field_id_t f = ref.fid();
     const auto storage =
       ref.topology()->template get_storage<T, ProcessorType>(f);
@@ -123,12 +136,12 @@ public:
 
 private:
   template<class P>
-  static bool get_selected(const topo::borrow_category<P> & b) {
-    return b.get_projection().selected();
+  static data::borrow::Claim get_claim(const topo::borrow_category<P> & b) {
+    return b.get_projection().claim();
   }
   template<class T>
-  static bool get_selected(const T &) {
-    return true;
+  static data::borrow::Claim get_claim(const T &) {
+    return run::context::instance().color();
   }
 
   std::vector<std::function<void(MPI_Request *)>> reductions;
@@ -38,7 +38,12 @@ enum task_attributes_mask_t : TaskAttributes {
   /// Run simultaneously on all processes with the obvious color mapping;
   /// allow MPI communication among point tasks, at the cost of significant
   /// startup overhead.
-  mpi = 0x40
+  mpi = 0x40,
+  /// Divide index launches over processors according to the time each point
+  /// took in previous launches, and let idle processors take waiting points.
+  ///
+  /// \note Ignored by the MPI backend.
+  balanced = 0x80
 }; // task_attributes_mask_t
 
 /// \c toc if support for it is available, otherwise \c loc.
@@ -98,7 +103,7 @@ mask_to_task_type(TaskAttributes mask) {
 constexpr task_processor_type_t
 mask_to_processor_type(TaskAttributes mask) {
   return static_cast<task_processor_type_t>(
-    util::bit_width(mask) - task_type_bits - 1);
+    util::bit_width(mask & ~balanced) - task_type_bits - 1);
 } // mask_to_processor_type
 
 /// \}
@@ -47,6 +47,12 @@ reduction_task(int a, exec::launch_domain) {
   return a + color();
 }
 
+std::tuple<int, int, double>
+multi_reduction_task(int a, exec::launch_domain) {
+  const int c = a + color();
+  return {c, c, 0.5 * c};
+}
+
 bool
 index_bool_task(exec::launch_domain) {
   return !color();
@@ -101,6 +107,28 @@ future_driver() {
     for(Color i = 0; i < run::context::instance().processes(); i++)
       sum += a + i;
     EXPECT_EQ(fsum.get(), sum);
+
+    // several reductions at once
+    auto fmulti = reduce<multi_reduction_task,
+      exec::fold::tuple<exec::fold::min, exec::fold::max, exec::fold::sum>>(
+      a, ld);
+    const auto [mmin, mmax, msum] = fmulti.get();
+    EXPECT_EQ(mmin, fmin.get());
+    EXPECT_EQ(mmax, fmax.get());
+    EXPECT_EQ(msum, 0.5 * sum);
+
+    // several colors per process
+    const exec::launch_domain od{2 * run::context::instance().processes()};
+    auto fo = execute<index_init>(f.get(), od);
+    for(Color i = 0; i < od.size_; ++i)
+      EXPECT_EQ(fo.get(i), f.get() + i);
+    EXPECT_EQ(test<check>(fo, energy), 0);
+
+    auto fosum = reduce<reduction_task, exec::fold::sum>(a, od);
+    sum = 0;
+    for(Color i = 0; i < od.size_; i++)
+      sum += a + i;
+    EXPECT_EQ(fosum.get(), sum);
   };
 } // future
 
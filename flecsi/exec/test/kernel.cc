@@ -135,6 +135,40 @@ reduce_mdrange_vec(intN::accessor<rw> a) {
   };
 }
 
+void
+mdtiles_init(intN::accessor<wo> a) {
+  auto ar = util::span(*a);
+  util::mdspan<std::size_t, 2> md_ar(ar.data(), {5, 2});
+  forall(mi, (mdtiles(md_ar, {3, 1}, full_range(), full_range())), "tiles") {
+    auto [i, j] = mi;
+    md_ar[j][i] = 5 * j + i + 1;
+  };
+  forall(
+    mi, (mdtiles(md_ar, {2, 2}, sub_range{1, 4}, prefix_range{2})), "sub") {
+    auto [i, j] = mi;
+    md_ar[j][i] = 0;
+  };
+}
+
+int
+reduce_mdtiles(intN::accessor<ro> a) {
+  UNIT() {
+    auto ar = util::span(*a);
+    util::mdspan<const std::size_t, 2> md_ar(ar.data(), {5, 2});
+    size_t res = reduceall(mi,
+      up,
+      mdtiles(md_ar, {2, 1}, full_range(), full_range()),
+      exec::fold::sum,
+      size_t,
+      "mdtiles_reduce") {
+      auto [i, j] = mi;
+      up(md_ar[j][i]);
+    };
+    // 1+...+10 less the cleared 2+3+4 and 7+8+9
+    EXPECT_EQ(res, 22u);
+  };
+}
+
 int
 kernel_driver() {
   UNIT() {
@@ -150,6 +184,8 @@ kernel_driver() {
     execute<modify_bound, default_accelerator>(ar);
     EXPECT_EQ(test<check_bound>(ar), 0);
     EXPECT_EQ((test<reduce_vec_bound, default_accelerator>(ar)), 0);
+    execute<mdtiles_init, default_accelerator>(ar);
+    EXPECT_EQ((test<reduce_mdtiles, default_accelerator>(ar)), 0);
   };
 } // kernel_driver
 
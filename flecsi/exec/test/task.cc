@@ -13,6 +13,7 @@ constexpr bool
 test() {
   static_assert(
     exec::mask_to_processor_type(P | leaf | inner | idempotent) == T);
+  static_assert(exec::mask_to_processor_type(P | leaf | balanced) == T);
   return true;
 }
 
@@ -175,9 +176,7 @@ task_driver() {
     ASSERT_EQ((execute<hydro::mpi, mpi>(&x).get(0)), 4);
     ASSERT_EQ(x, 1); // NB: MPI calls are synchronous
 
-    EXPECT_EQ(test<index_task>(exec::launch_domain{
-                processes() + 4 * (FLECSI_BACKEND != FLECSI_BACKEND_mpi)}),
-      0);
+    EXPECT_EQ(test<index_task>(exec::launch_domain{processes() + 4}), 0);
 
     // Test reduction
     auto np = processes();
@@ -540,7 +540,6 @@ inline constexpr bool can_dumpstack =
              << FLOG_OUTPUT_YELLOW(::flecsi::flog::rstrip<'/'>(__FILE__)       \
                                    << ":" << __LINE__ << " ")                  \
              << FLOG_OUTPUT_LTRED(message) << std::endl;                       \
-    FLOG_RESET();                                                              \
     const char * dump = std::getenv("FLECSI_BACKTRACE");                       \
     if(dump != nullptr) {                                                      \
       ::flecsi::flog::dumpstack();                                             \
@@ -552,6 +551,7 @@ inline constexpr bool can_dumpstack =
                     "`$ export FLECSI_BACKTRACE=1`.")                          \
                << std::endl;                                                   \
     }                                                                          \
+    FLOG_RESET(); /* after the last use of the colors */                       \
     std::cerr << _sstream.rdbuf() << std::endl;                                \
     std::abort();                                                              \
   } /* scope */
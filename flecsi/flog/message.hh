@@ -20,6 +20,10 @@ namespace flog {
 /*!
   The message type provides a basic log message type that is customized
   with a formatting policy.
+
+  With MPI, arguments of common types are recorded in a \c packet_t to be
+  formatted later; after any other argument, the rest are formatted
+  immediately so that manipulators apply as usual.
  */
 
 template<typename Policy>
@@ -31,8 +35,12 @@ struct message {
     std::cerr << FLOG_COLOR_LTGRAY << "FLOG: log_message_t constructor " << file
               << " " << line << FLOG_COLOR_PLAIN << std::endl;
 #endif
-    if(!state::instance().active_process())
+    if(!state::instance().active_process()) {
       ss_.clear(std::ios_base::badbit);
+#if defined(FLOG_ENABLE_MPI)
+      active_ = false;
+#endif
+    }
   }
 
   ~message() {
@@ -46,6 +54,12 @@ struct message {
               << FLOG_COLOR_PLAIN << std::endl;
 #endif
 
+#if defined(FLOG_ENABLE_MPI)
+    spill();
+    if(clean_)
+      packet_.finish(FLOG_COLOR_PLAIN);
+    state::instance().buffer_output(std::move(packet_));
+#else
     if(clean_) {
       auto str = ss_.str();
       if(str.back() == '\n') {
@@ -58,10 +72,6 @@ struct message {
       }
     } // if
 
-#if defined(FLOG_ENABLE_MPI)
-    assert(state::instance);
-    state::instance().buffer_output(std::move(ss_).str());
-#else
     std::cout << ss_.rdbuf();
 #endif // FLOG_ENABLE_MPI
   }
@@ -72,6 +82,17 @@ struct message {
 
   template<typename T>
   message & operator<<(T const & value) {
+#if defined(FLOG_ENABLE_MPI)
+    if(!active_)
+      return *this;
+    if constexpr(packet_t::deferred<T>) {
+      if(!eager_) {
+        packet_.put(value);
+        return *this;
+      }
+    }
+    eager_ = true;
+#endif
     ss_ << value;
     return *this;
   }
@@ -82,6 +103,15 @@ struct message {
 
   message & operator<<(
     ::std::ostream & (*basic_manipulator)(::std::ostream & stream)) {
+#if defined(FLOG_ENABLE_MPI)
+    if(!eager_ &&
+       basic_manipulator == static_cast<::std::ostream & (*)(::std::ostream &)>(
+                              ::std::endl)) {
+      packet_.text("\n");
+      return *this;
+    }
+    eager_ = true;
+#endif
     ss_ << basic_manipulator;
     return *this;
   }
@@ -93,6 +123,9 @@ struct message {
   message & format() {
     clean_ = state::instance().verbose() >= 0 &&
              Policy::format(ss_, file_, line_, devel_);
+#if defined(FLOG_ENABLE_MPI)
+    spill();
+#endif
     return *this;
   }
 
@@ -110,6 +143,16 @@ private:
   bool devel_;
   bool clean_{false};
   std::stringstream ss_;
+#if defined(FLOG_ENABLE_MPI)
+  // Move formatted output to the packet.
+  void spill() {
+    packet_.text(ss_.str());
+    ss_.str({});
+  }
+
+  bool active_ = true, eager_ = false;
+  packet_t packet_;
+#endif
 }; // message
 
 /// \}
@@ -8,24 +8,15 @@
 
 #if defined(FLECSI_ENABLE_FLOG)
 
-#if defined(FLOG_ENABLE_MPI)
-#include <mpi.h>
-#endif
-
-#if defined(_MSC_VER)
-#error "Need implementation for Windows"
-#endif
-
-#include <sys/time.h>
-
-#include <algorithm>
-#include <array>
+#include <chrono>
+#include <cstdint>
 #include <cstring>
-#include <iostream>
-#include <mutex>
 #include <sstream>
-#include <thread>
-#include <vector>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 /// \cond core
 namespace flecsi {
@@ -35,64 +26,167 @@ namespace flog {
 
 /*!
   Packet type for serializing output from distributed-memory tasks.
+
+  A packet records the arguments of one message in a compact binary form:
+  values of fundamental types and strings are copied as they are and
+  formatted only when the packet is printed.  Its timestamp comes from a
+  monotonic clock, offset to agree approximately with the system clock so
+  that packets from different processes can be merged.
  */
 
 struct packet_t {
-  static constexpr size_t sec_bytes = sizeof(time_t);
-  static constexpr size_t usec_bytes = sizeof(suseconds_t);
-  static constexpr size_t max_message_size = 4096;
-  static constexpr size_t packet_bytes =
-    sec_bytes + usec_bytes + max_message_size;
-
-  packet_t(const char * msg = nullptr) {
-    timeval stamp;
-    if(gettimeofday(&stamp, NULL)) {
-      std::cerr << "FLOG: call to gettimeofday failed!!! " << __FILE__
-                << __LINE__ << std::endl;
-      std::exit(1);
-    } // if
-
-    std::memcpy(bytes_.data(), &stamp.tv_sec, sec_bytes);
-    std::memcpy(bytes_.data() + sec_bytes, &stamp.tv_usec, usec_bytes);
-
-    std::ostringstream oss;
-    if(msg)
-      oss << msg;
-
-    strcpy(bytes_.data() + sec_bytes + usec_bytes, oss.str().c_str());
-  } // packet_t
-
-  time_t seconds() const {
-    return get<time_t>(bytes_.data());
-  } // seconds
-
-  suseconds_t useconds() const {
-    return get<suseconds_t>(bytes_.data() + sec_bytes);
-  } // seconds
-
-  const char * message() {
-    return bytes_.data() + sec_bytes + usec_bytes;
-  } // message
+  /// Types stored in binary form.
+  using binary = std::tuple<bool,
+    char,
+    signed char,
+    unsigned char,
+    short,
+    unsigned short,
+    int,
+    unsigned,
+    long,
+    unsigned long,
+    long long,
+    unsigned long long,
+    float,
+    double,
+    long double,
+    const void *>;
+
+private:
+  template<class T, std::size_t... II>
+  static constexpr std::size_t find(std::index_sequence<II...>) {
+    std::size_t ret = std::tuple_size_v<binary>;
+    ((std::is_same_v<T, std::tuple_element_t<II, binary>> ? ret = II : 0),
+      ...);
+    return ret;
+  }
+  template<class T>
+  static constexpr std::size_t index =
+    find<T>(std::make_index_sequence<std::tuple_size_v<binary>>());
+
+  // Item kinds beyond the binary types:
+  static constexpr unsigned char text_kind = std::tuple_size_v<binary>,
+                                 finish_kind = text_kind + 1;
+
+  // Pointers that print as an address or as text.  Other pointers are
+  // formatted immediately: printing a std::streambuf *, for example, reads
+  // from the buffer.
+  template<class T, class P = std::remove_pointer_t<T>>
+  static constexpr bool plain_pointer = std::is_pointer_v<T> &&
+    (std::is_same_v<std::remove_const_t<P>, void> ||
+      std::is_same_v<std::remove_const_t<P>, char>);
+
+public:
+  /// Whether a value of type \a T is recorded without formatting.
+  template<class T>
+  static constexpr bool deferred =
+    index<T> < text_kind || std::is_same_v<T, std::string> ||
+    std::is_same_v<T, std::string_view> ||
+    (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>) ||
+    plain_pointer<T>;
+
+  /// Return the current time in nanoseconds.
+  static std::int64_t now() {
+    using namespace std::chrono;
+    static const auto offset = system_clock::now().time_since_epoch() -
+                               steady_clock::now().time_since_epoch();
+    return duration_cast<nanoseconds>(
+      steady_clock::now().time_since_epoch() + offset)
+      .count();
+  }
+
+  /// Record a value.
+  /// \tparam T a type for which \c deferred is \c true
+  template<class T>
+  void put(const T & t) {
+    if constexpr(index<T> < text_kind)
+      bytes(index<T>, &t, sizeof t);
+    else if constexpr(plain_pointer<T>) {
+      if constexpr(!std::is_void_v<std::remove_pointer_t<T>>) {
+        if(t) {
+          text(t);
+          return;
+        }
+      }
+      put(static_cast<const void *>(t));
+    }
+    else
+      text(t);
+  }
+  /// Record text.
+  void text(std::string_view s) {
+    if(!s.empty())
+      string(text_kind, s);
+  }
+  /// Insert \a s before any trailing newline when printing, or else append
+  /// it.  Call at most once, after all other items.
+  void finish(std::string_view s) {
+    string(finish_kind, s);
+  }
 
-  const char * data() const {
-    return bytes_.data();
-  } // data
+  /// Format the message.
+  std::string message() const {
+    std::ostringstream ss;
+    for(const char *p = data.data(), *const e = p + data.size(); p != e;) {
+      const auto k = static_cast<unsigned char>(*p++);
+      if(k < text_kind)
+        print(ss,
+          k,
+          p,
+          std::make_index_sequence<std::tuple_size_v<binary>>());
+      else {
+        const std::string_view s(p + sizeof(std::size_t), get<std::size_t>(p));
+        p += sizeof(std::size_t) + s.size();
+        if(k == text_kind)
+          ss << s;
+        else {
+          auto ret = std::move(ss).str();
+          ret.insert(ret.empty() || ret.back() != '\n' ? ret.size()
+                                                       : ret.size() - 1,
+            s);
+          return ret;
+        }
+      }
+    }
+    return std::move(ss).str();
+  } // message
 
   bool operator<(packet_t const & b) const {
-    return this->seconds() == b.seconds() ? this->useconds() < b.useconds()
-                                          : this->seconds() < b.seconds();
+    return time < b.time;
   } // operator <
 
+  std::int64_t time = 0; ///< Nanoseconds since the epoch.
+  std::string data; ///< Encoded items.
+
 private:
   template<class T>
-  static T get(const void * p) {
+  static T get(const char * p) {
     T ret;
-    std::memcpy(&ret, p, sizeof ret);
+    std::memcpy(static_cast<void *>(&ret), p, sizeof ret);
     return ret;
   }
 
-  std::array<char, packet_bytes> bytes_;
+  void bytes(unsigned char k, const void * p, std::size_t n) {
+    data += static_cast<char>(k);
+    data.append(static_cast<const char *>(p), n);
+  }
+  void string(unsigned char k, std::string_view s) {
+    const std::size_t n = s.size();
+    bytes(k, &n, sizeof n);
+    data += s;
+  }
 
+  template<std::size_t... II>
+  static void print(std::ostream & o,
+    unsigned char k,
+    const char *& p,
+    std::index_sequence<II...>) {
+    ((k == II ? (o << get<std::tuple_element_t<II, binary>>(p),
+                  p += sizeof(std::tuple_element_t<II, binary>))
+              : p),
+      ...);
+  }
 }; // packet_t
 
 /// \}
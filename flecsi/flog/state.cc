@@ -4,9 +4,26 @@
 #include "flecsi/flog/utils.hh"
 #include "flecsi/util/mpi.hh"
 
+#include <algorithm>
+
 #if defined(FLECSI_ENABLE_FLOG)
 
 namespace flecsi {
+template<>
+struct util::serial::traits<flog::packet_t> {
+  using type = flog::packet_t;
+  template<class P>
+  static void put(P & p, const type & k) {
+    serial::put(p, k.time, k.data);
+  }
+  static type get(const std::byte *& p) {
+    type ret;
+    ret.time = serial::get<std::int64_t>(p);
+    ret.data = serial::get<std::string>(p);
+    return ret;
+  }
+};
+
 namespace flog {
 
 #ifdef FLOG_ENABLE_TAGS
@@ -30,6 +47,7 @@ state::send_to_one(bool last) {
   using util::mpi::test;
 
   std::lock_guard guard(packets_mutex_);
+  collect();
 
   std::vector<int> sizes(process_ ? 0 : processes_), offsets(sizes);
   std::vector<std::byte> data, buffer;
@@ -116,7 +134,8 @@ void
 state::flush_packets() {
   std::unique_lock lk(packets_mutex_);
   while(true) {
-    std::sort(packets_.begin(), packets_.end());
+    // Each thread's packets are already in order.
+    std::stable_sort(packets_.begin(), packets_.end());
 
     for(auto & p : packets_) {
       stream_ << p.message();
@@ -13,15 +13,25 @@
 #include "flecsi/flog/types.hh"
 #include "flecsi/flog/utils.hh"
 
+#if defined(FLOG_ENABLE_MPI)
+#include <mpi.h>
+#endif
+
+#include <array>
 #include <atomic>
 #include <bitset>
 #include <cassert>
 #include <condition_variable>
 #include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 /// \cond core
 namespace flecsi {
@@ -32,6 +42,42 @@ namespace flog {
 /// \addtogroup flog
 /// \{
 
+#if defined(FLOG_ENABLE_MPI)
+namespace detail {
+// The packets from one thread.  Only that thread adds to the ring, without
+// locking; others remove packets only while holding the mutex.
+struct thread_log {
+  static constexpr std::size_t capacity = 1 << 10;
+
+  void push(packet_t && p) {
+    const auto t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) == capacity) {
+      std::lock_guard guard(mutex);
+      drain(overflow);
+    }
+    ring[t % capacity] = std::move(p);
+    tail.store(t + 1, std::memory_order_release);
+  }
+
+  // Move out all packets, oldest first.  Call with the mutex held.
+  void drain(std::vector<packet_t> & out) {
+    const auto h = head.load(std::memory_order_relaxed),
+               t = tail.load(std::memory_order_acquire);
+    for(auto i = h; i != t; ++i)
+      out.push_back(std::move(ring[i % capacity]));
+    head.store(t, std::memory_order_release);
+  }
+
+  std::mutex mutex;
+  std::vector<packet_t> overflow; // older than the ring contents
+
+private:
+  std::array<packet_t, capacity> ring;
+  std::atomic<std::size_t> head{0}, tail{0};
+};
+} // namespace detail
+#endif
+
 /*!
   The state type provides access to logging parameters and configuration.
 
@@ -251,19 +297,10 @@ public:
     return process_;
   }
 
-  void buffer_output(std::string const & message) {
-    // Make sure that the string fits within the packet size.
-    if(message.size() > packet_t::max_message_size) {
-      std::ostringstream stream;
-      stream << std::string_view(message).substr(
-                  0, packet_t::max_message_size - 100)
-             << FLOG_COLOR_LTRED << " OUTPUT BUFFER TRUNCATED TO "
-             << packet_t::max_message_size << " BYTES (" << message.size()
-             << ")" << FLOG_COLOR_PLAIN << std::endl;
-      buffer(std::move(stream).str());
-    } // if
-    else
-      buffer(message);
+  /// Record a message from the calling thread.
+  void buffer_output(packet_t && p) {
+    p.time = packet_t::now();
+    log().push(std::move(p));
   }
 
   std::vector<packet_t> & packets() {
@@ -275,7 +312,9 @@ public:
   // Can be used as MPI tasks:
 
   /// Return number of buffered packets.
-  static std::size_t log_size(const state & s) {
+  static std::size_t log_size(state & s) {
+    std::lock_guard guard(s.packets_mutex_);
+    s.collect();
     return s.packets_.size();
   }
   /// Gather log output on the root.
@@ -314,12 +353,34 @@ private:
   static inline std::vector<std::string> tag_names;
 
 #if defined(FLOG_ENABLE_MPI)
-  void buffer(const std::string & s) {
-    std::lock_guard<std::mutex> guard(packets_mutex_);
-    packets_.push_back({s.c_str()});
+  detail::thread_log & log() {
+    thread_local detail::thread_log * mine;
+    thread_local unsigned gen = 0;
+    if(gen != generation_) {
+      std::lock_guard guard(logs_mutex_);
+      mine = logs_.emplace_back(std::make_unique<detail::thread_log>()).get();
+      gen = generation_;
+    }
+    return *mine;
+  }
+  // Move all recorded packets to packets_, which must be locked.
+  void collect() {
+    std::lock_guard guard(logs_mutex_);
+    for(auto & l : logs_) {
+      std::lock_guard g(l->mutex);
+      for(auto & p : l->overflow)
+        packets_.push_back(std::move(p));
+      l->overflow.clear();
+      l->drain(packets_);
+    }
   }
   void send_to_one(bool last);
 
+  static inline std::atomic<unsigned> generations;
+  const unsigned generation_ = ++generations; // distinguishes thread logs
+  std::mutex logs_mutex_;
+  std::vector<std::unique_ptr<detail::thread_log>> logs_;
+
   Color source_process_, process_, processes_;
   std::thread flusher_thread_;
   std::mutex packets_mutex_;
@@ -12,6 +12,7 @@
 #include "flecsi/flog/utils.hh"
 
 #include <cassert>
+#include <iostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -75,6 +75,25 @@ arguments::getopt(int argc, char ** argv) {
     po::value<backend_arg::single>(),
     "Pass single argument to the backend. This option can be passed "
     "multiple times.");
+  flecsi_desc.add_options() // clang-format off
+      (
+        "profile",
+        po::bool_switch(&cfg.profile.summary),
+        "Time annotated regions (independently of Caliper) and print a"
+        " summary table at exit."
+      )
+      (
+        "profile-trace",
+        po::value(&cfg.profile.trace),
+        "Time annotated regions and write them to the given file in the"
+        " Chrome trace format at exit."
+      )
+      (
+        "profile-buffer",
+        po::value(&cfg.profile.buffer)->default_value(cfg.profile.buffer),
+        "Number of events retained per thread for --profile-trace."
+      ); // clang-format on
+
 #if defined(FLECSI_ENABLE_FLOG)
   std::string flog_tags_;
   // Add FleCSI options
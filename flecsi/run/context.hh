@@ -9,6 +9,7 @@
 #include "flecsi/flog.hh"
 #include "flecsi/util/constant.hh"
 #include "flecsi/util/demangle.hh"
+#include "flecsi/util/profile.hh"
 
 #include <boost/optional.hpp>
 #include <boost/program_options.hpp>
@@ -113,6 +114,10 @@ struct arguments {
 #ifdef FLECSI_ENABLE_FLOG
     flecsi::flog::config flog; ///< Flog options, if that feature is enabled.
 #endif
+    /// Built-in profiler options.
+    /// Populated from \c \--profile, \c \--profile-trace, and
+    /// \c \--profile-buffer options.
+    util::profile::config profile;
     /// Command line for FleCSI backend.  Some backends ignore it.
     /// Populated from \c \--Xbackend and \c \--backend-args options.
     argv backend;
@@ -210,9 +215,8 @@ protected:
 
 #if defined(FLECSI_ENABLE_FLOG)
     flog::state::set_instance(c.flog);
-#else
-    (void)c;
 #endif
+    util::profile::configure(c.profile);
   }
 
   ~context() {
@@ -354,6 +358,27 @@ public:
     return tita->second[Topo::index_spaces::template index<Index>];
   } // field_info_store
 
+  /*!
+    Record that fields should share storage where the backend supports it.
+
+    \param ids field IDs, all on the same index space
+   */
+  static void add_field_group(std::vector<field_id_t> ids) {
+    const auto g = std::make_shared<const std::vector<field_id_t>>(
+      std::move(ids));
+    for(const auto f : *g)
+      if(!field_groups_.try_emplace(f, g).second)
+        flog_fatal("field " << f << " is already in a group");
+  } // add_field_group
+
+  /*!
+    Return the group containing a field, or null if there is none.
+   */
+  static const std::vector<field_id_t> * field_group(field_id_t id) {
+    const auto i = field_groups_.find(id);
+    return i == field_groups_.end() ? nullptr : i->second.get();
+  } // field_group
+
   /*--------------------------------------------------------------------------*
     Index space interface.
    *--------------------------------------------------------------------------*/
@@ -480,6 +505,11 @@ protected:
   /// Set of topology types for which field definitions have been used
   static inline std::set<TopologyType> topology_ids_;
 
+  /// The group (if any) of each field
+  static inline std::map<field_id_t,
+    std::shared_ptr<const std::vector<field_id_t>>>
+    field_groups_;
+
   /*--------------------------------------------------------------------------*
     Index space data members.
    *--------------------------------------------------------------------------*/
@@ -15,6 +15,7 @@
 
 #include <functional>
 #include <map>
+#include <optional>
 #include <vector>
 
 namespace flecsi {
@@ -40,6 +41,19 @@ inline program_option<bool> control_model_sorted_option("FleCSI Options",
   {{flecsi::option_implicit, true}, {flecsi::option_zero}});
 #endif
 
+#if FLECSI_BACKEND == FLECSI_BACKEND_mpi
+inline program_option<int> control_threads_option("FleCSI Options",
+  "control-threads",
+  "Number of host threads used to execute actions that do not depend on "
+  "each other concurrently. Each such action launches tasks only after "
+  "those before it in the sorted order have finished; it must not perform "
+  "other collective operations.",
+  {{flecsi::option_default, 1}},
+  [](int n, std::stringstream & ss) {
+    return n > 0 || ((ss << "control-threads must be positive"), false);
+  });
+#endif
+
 /// A control point for application use.
 /// \tparam CP control point enumerator
 /// \deprecated Use \c control_base::point.
@@ -115,7 +129,10 @@ inline const char * operator*(control_policy::control_points_enum);
   with each node of the graph specifying a set of actions as a
   directed acyclic graph (DAG). The actions under a control point
   DAG are topologically sorted to respect dependency edges, which can
-  be specified through the dag interface.
+  be specified through the dag interface.  The sorted order is computed
+  once and reused until further actions or dependencies are registered.
+  With the MPI backend, the \c --control-threads option allows actions that
+  do not depend on each other to be executed concurrently.
 
   If Graphviz support is enabled, the control flow graph and its DAG nodes
   can be written to a graphviz file that can be compiled and viewed using
@@ -182,6 +199,8 @@ private:
 
 public:
   using sorted_type = std::map<control_points_enum, typename dag::sorted_type>;
+  using schedule_type =
+    std::map<control_points_enum, std::vector<typename dag::sorted_type>>;
   using dag_map = std::map<control_points_enum, dag>;
 
 private:
@@ -203,6 +222,7 @@ private:
     Return the dag at the given control point.
   */
   dag & control_point_dag(control_points_enum cp) {
+    schedule_.reset();
     registry_.try_emplace(cp, *cp);
     return registry_[cp];
   }
@@ -218,12 +238,37 @@ private:
     return sorted;
   }
 
+  /*
+    Return the levels of the sorted dags under each control point, computing
+    them if any registration has happened since the last call.
+  */
+  const schedule_type & schedule() {
+    if(!schedule_) {
+      schedule_.emplace();
+      for(auto & d : registry_) {
+        schedule_->try_emplace(d.first, d.second.levels());
+      }
+    }
+    return *schedule_;
+  }
+
   /*
     Run the control model.
   */
-  int run(P * p) const {
+  int run(P * p) {
     int status{flecsi::run::status::success};
-    run_impl::walk<control_points>(point_walker(sort(), status, p));
+    unsigned threads = 1;
+#if FLECSI_BACKEND == FLECSI_BACKEND_mpi
+    if(control_threads_option.has_value())
+      threads = control_threads_option.value();
+#endif
+    if(threads > 1) {
+      util::thread_pool pool(threads);
+      run_impl::walk<control_points>(
+        point_walker(schedule(), status, p, &pool));
+    }
+    else
+      run_impl::walk<control_points>(point_walker(schedule(), status, p));
     return status;
   } // run
 
@@ -247,6 +292,7 @@ private:
 #endif
 
   dag_map registry_;
+  std::optional<schedule_type> schedule_;
   std::conditional_t<is_control_base_policy, std::nullptr_t, P> policy_;
 
 public:
@@ -314,6 +360,7 @@ public:
         "you cannot add dependencies between actions under different control "
         "points");
       node_.push_back(&from.node_);
+      instance().schedule_.reset();
       return {};
     }
 
@@ -330,10 +377,12 @@ public:
   /*!
     Execute the control model. This method does a topological sort of the
     actions under each of the control points to determine a non-unique, but
-    valid ordering, and executes the actions.  If the policy `P` inherits from
-    `control_base`, an object of type \c P is initialized from \a aa and
-    destroyed before this function returns.
-    \c control_base::exception can be thrown for early
+    valid ordering, and executes the actions.  With \c --control-threads,
+    actions that are not ordered by dependencies may run concurrently; each
+    waits to launch a task until those before it in the sorted order have
+    finished.  If the policy `P` inherits from `control_base`, an object of
+    type \c P is initialized from \a aa and destroyed before this function
+    returns.  \c control_base::exception can be thrown for early
     termination.
     \param aa only if inheriting from \c control_base
     \return code from a thrown \c control_base::exception or the
@@ -122,7 +122,9 @@ context_t::start(const std::function<int()> & action) {
     mpi_task_ = nullptr;
   }
 
-  return Legion::Runtime::wait_for_shutdown();
+  const int ret = Legion::Runtime::wait_for_shutdown();
+  util::profile::report();
+  return ret;
 } // context_t::start
 
 } // namespace run
@@ -38,7 +38,9 @@ inline constexpr Legion::MappingTagID
   exclusive_lr = 0x00004000, ///< Indicate first region in compacted set.
 #endif
   prefer_gpu = 0x11000001, ///< Request GPU execution.
-  prefer_omp = 0x11000002; ///< Request OpenMP execution.
+  prefer_omp = 0x11000002, ///< Request OpenMP execution.
+  /// Slice by measured cost and allow stealing; combined with the others.
+  balance = 0x00100000;
 /// \}
 /// \}
 } // namespace mapper
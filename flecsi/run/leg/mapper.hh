@@ -6,11 +6,20 @@
 
 #include "../backend.hh"
 #include "flecsi/config.hh"
+#include "flecsi/run/options.hh"
 
 #include <legion.h>
 #include <legion/legion_mapping.h>
 #include <mappers/default_mapper.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 namespace flecsi {
 
 inline flog::devel_tag legion_mapper_tag("legion_mapper");
@@ -19,6 +28,29 @@ namespace run {
 /// \addtogroup legion-runtime
 /// \{
 
+inline program_option<int> instance_budget_option("FleCSI Options",
+  "instance-budget",
+  "Maximum size in MiB of the physical instances kept by the mappers in each "
+  "memory (0 for no limit). Beyond it, the least recently used instances "
+  "are released for collection by Legion.",
+  {{flecsi::option_default, 0}},
+  [](int n, std::stringstream & ss) {
+    return n >= 0 || ((ss << "instance-budget must be non-negative"), false);
+  });
+
+inline program_option<bool> instance_report_option("FleCSI Options",
+  "instance-report",
+  "Report the bytes of physical instances kept by the mappers in each memory "
+  "whenever they reach a new maximum or instances are released.",
+  {{flecsi::option_implicit, true}, {flecsi::option_zero}});
+
+inline program_option<bool> balance_launches_option("FleCSI Options",
+  "balance-launches",
+  "Divide all index launches over processors according to the measured "
+  "time of each point, as if every task had the balanced attribute (but "
+  "without stealing).",
+  {{flecsi::option_implicit, true}, {flecsi::option_zero}});
+
 /*!
  The mpi_mapper_t - is a custom mapper that handles mpi-legion
  interoperability in FLeCSI
@@ -81,6 +113,19 @@ public:
     else {
       local_framebuffer = Memory::NO_MEMORY;
     }
+    // On multi-socket nodes, Realm may provide a memory for each NUMA domain
+    // (e.g., with -ll:nsize).  Use the one nearest to each local processor.
+    for(const auto * v : {&local_cpus, &local_omps})
+      for(const Processor p : *v) {
+        Machine::MemoryQuery socket_query(machine);
+        socket_query.local_address_space();
+        socket_query.only_kind(Memory::SOCKET_MEM);
+        socket_query.best_affinity_to(p);
+        const Memory m = socket_query.first();
+        host_memory[p] = m.exists() ? m : local_sysmem;
+        flog_devel(info) << "processor " << p.id << " uses memory "
+                         << host_memory[p].id << std::endl;
+      }
   } // end mpi_mapper_t
 
   /*!
@@ -191,7 +236,8 @@ public:
       if(finder2 != innerMap.end()) {
         for(size_t j = 0; j < 3; j++) {
           output.chosen_instances[indx + j].clear();
-          output.chosen_instances[indx + j].push_back(finder2->second);
+          output.chosen_instances[indx + j].push_back(
+            finder2->second.instance);
         } // for
         return;
       } // if
@@ -205,7 +251,8 @@ public:
     flog_assert((task.regions[indx].region.exists()),
       "ERROR:: pasing not existing REGION to the mapper");
 
-    Legion::Mapping::PhysicalInstance & result = local_instances_[key1][key2];
+    Legion::Mapping::PhysicalInstance & result =
+      local_instances_[key1][key2].instance;
     // compacting region requirements for exclusive, shared and ghost into one
     // instance
     result = get_instance(ctx,
@@ -227,7 +274,8 @@ public:
    This function will create regular PhysicalInstance for a task.
    It will first check already created instances (checking
    local_instances_) and create a new one only if it wasn't already created in
-   requested memory space
+   requested memory space.  An instance for a field in a \c field_group holds
+   all the fields of the group.
   */
   void create_instance(const Legion::Mapping::MapperContext ctx,
     const Legion::Task & task,
@@ -243,23 +291,42 @@ public:
       return;
 
     // check if instance was already created and stored in the
-    // local_instamces_ map
+    // local_instamces_ map; any instance with all the fields will do
     const std::pair<Legion::LogicalRegion, Legion::Memory> key1(r, target_mem);
-    auto key2 = task.regions[indx].privilege_fields;
-    instance_map_t::const_iterator finder1 = local_instances_.find(key1);
+    const auto & fields = task.regions[indx].privilege_fields;
+    instance_map_t::iterator finder1 = local_instances_.find(key1);
     if(finder1 != local_instances_.end()) {
-      const field_instance_map_t & innerMap = finder1->second;
-      field_instance_map_t::const_iterator finder2 = innerMap.find(key2);
-      if(finder2 != innerMap.end()) {
-        output.chosen_instances[indx].clear();
-        output.chosen_instances[indx].push_back(finder2->second);
-        return;
-      } // if
+      for(auto & [key2, c] : finder1->second)
+        if(std::includes(
+             key2.begin(), key2.end(), fields.begin(), fields.end())) {
+          c.last_use = clock;
+          output.chosen_instances[indx].clear();
+          output.chosen_instances[indx].push_back(c.instance);
+          return;
+        } // if
     } // if
 
-    output.chosen_instances[indx].push_back(
-      local_instances_[key1][key2] =
-        get_instance(ctx, task, target_mem, layout_constraints, indx, {r}));
+    // Add the rest of any field groups (that belong to this region).
+    auto key2 = fields;
+    std::set<FieldID> space;
+    for(const auto f : fields)
+      if(const auto * g = run::context::field_group(f)) {
+        if(space.empty())
+          runtime->get_field_space_fields(ctx, r.get_field_space(), space);
+        for(const auto h : *g)
+          if(space.count(h))
+            key2.insert(h);
+      }
+
+    // Have all the fields for the instance available
+    LayoutConstraintSet constraints = layout_constraints;
+    constraints.add_constraint(
+      FieldConstraint(std::vector<FieldID>(key2.begin(), key2.end()), true));
+    cached_instance & c = local_instances_[key1][key2];
+    c.last_use = clock;
+    c.instance = get_instance(ctx, task, target_mem, constraints, indx, {r});
+    output.chosen_instances[indx].push_back(c.instance);
+    hold(ctx, target_mem, c.instance);
   } // create_instance
 
   /*!
@@ -274,6 +341,14 @@ public:
 
    3) It has logic on how to create compacted instances;
 
+   4) It allocates the fields of each field_group together;
+
+   5) It places instances for host processors in the memory nearest to the
+      processor selected by slice_task, and lets the task run only on
+      processors that share that memory;
+
+   6) It requests the time taken by each point of a balanced index launch.
+
     @param ctx Mapper Context
     @param task Legion's task
     @param output Output information about task mapping
@@ -288,12 +363,16 @@ public:
     using namespace Legion::Mapping;
     using namespace mapper;
 
-    if(task.tag == prefer_gpu && !local_gpus.empty()) {
+    ++clock;
+    if(task.is_index_space && cost_sliced(task))
+      output.task_prof_requests
+        .add_measurement<Realm::ProfilingMeasurements::OperationTimeline>();
+    if(kind(task) == prefer_gpu && !local_gpus.empty()) {
       output.chosen_variant = find_variant(
         ctx, task.task_id, gpu_variants, Legion::Processor::TOC_PROC);
       output.target_procs.push_back(task.target_proc);
     }
-    else if(task.tag == prefer_omp && !local_omps.empty()) {
+    else if(kind(task) == prefer_omp && !local_omps.empty()) {
       output.chosen_variant = find_variant(
         ctx, task.task_id, omp_variants, Legion::Processor::OMP_PROC);
       output.target_procs = local_omps;
@@ -301,7 +380,11 @@ public:
     else {
       output.chosen_variant = find_variant(
         ctx, task.task_id, cpu_variants, Legion::Processor::LOC_PROC);
-      output.target_procs = local_cpus;
+      const Memory m = near_memory(task.target_proc);
+      output.target_procs.push_back(task.target_proc);
+      for(const Processor p : local_cpus)
+        if(p != task.target_proc && near_memory(p) == m)
+          output.target_procs.push_back(p);
     }
 
     output.chosen_instances.resize(task.regions.size());
@@ -313,10 +396,10 @@ public:
       //     DefaultMapper::default_policy_select_target_memory(
       //       ctx, task.target_proc, task.regions[0]);
 
-      if(task.tag == prefer_gpu && !local_gpus.empty())
+      if(kind(task) == prefer_gpu && !local_gpus.empty())
         target_mem = local_framebuffer;
       else
-        target_mem = local_sysmem;
+        target_mem = near_memory(task.target_proc);
 
       // creating ordering constraint (SOA )
       std::vector<Legion::DimensionKind> ordering;
@@ -344,13 +427,6 @@ public:
         // Constrained for the target memory kind
         layout_constraints.add_constraint(
           Legion::MemoryConstraint(target_mem.kind()));
-        // Have all the field for the instance available
-        std::vector<Legion::FieldID> all_fields;
-        for(auto fid : task.regions[indx].privilege_fields) {
-          all_fields.push_back(fid);
-        } // for
-        layout_constraints.add_constraint(
-          Legion::FieldConstraint(all_fields, true));
 
         // creating physical instance for the reduction task
         if(task.regions[indx].privilege == REDUCE) {
@@ -371,6 +447,7 @@ public:
         } // end if
       } // end for
 
+      evict(ctx, target_mem);
     } // end if
 
     runtime->acquire_instances(ctx, output.chosen_instances);
@@ -392,7 +469,7 @@ public:
     using namespace Legion;
     using namespace mapper;
 
-    switch(task.tag) {
+    switch(kind(task)) {
 #if 0 // this is not supported in FleCSI yet
       // when we launch subtasks
       // this tag is used to map nested tasks
@@ -438,50 +515,66 @@ public:
       default:
         // We've already been control replicated, so just divide our points
         // over the local processors, depending on which kind we prefer
-        if(task.tag == prefer_gpu && !local_gpus.empty()) {
-          unsigned local_gpu_index = 0;
-          for(Domain::DomainPointIterator itr(input.domain); itr; itr++) {
-            TaskSlice slice;
-            slice.domain = Domain(itr.p, itr.p);
-            slice.proc = local_gpus[local_gpu_index++];
-            if(local_gpu_index == local_gpus.size())
-              local_gpu_index = 0;
-            slice.recurse = false;
-            slice.stealable = false;
-            output.slices.push_back(slice);
-          }
-        }
-        else if(task.tag == prefer_omp && !local_omps.empty()) {
-          unsigned local_omp_index = 0;
-          for(Domain::DomainPointIterator itr(input.domain); itr; itr++) {
-            TaskSlice slice;
-            slice.domain = Domain(itr.p, itr.p);
-            slice.proc = local_omps[local_omp_index++];
-            if(local_omp_index == local_omps.size())
-              local_omp_index = 0;
-            slice.recurse = false;
-            slice.stealable = false;
-            output.slices.push_back(slice);
-          }
-        }
-        else {
-          // Opt for our cpus instead of our OpenMP processors
-          unsigned local_cpu_index = 0;
-          for(Domain::DomainPointIterator itr(input.domain); itr; itr++) {
-            TaskSlice slice;
-            slice.domain = Domain(itr.p, itr.p);
-            slice.proc = local_cpus[local_cpu_index++];
-            if(local_cpu_index == local_cpus.size())
-              local_cpu_index = 0;
-            slice.recurse = false;
-            slice.stealable = false;
-            output.slices.push_back(slice);
-          }
-        }
+        const auto & procs =
+          kind(task) == prefer_gpu && !local_gpus.empty()   ? local_gpus
+          : kind(task) == prefer_omp && !local_omps.empty() ? local_omps
+                                                            : local_cpus;
+        if(cost_sliced(task))
+          slice_by_cost(task, input.domain, procs, output);
+        else
+          slice_points(input.domain, procs, output);
     }
 
   } // slice_task
 
+  /*!
+   Record the time taken by each point of a balanced index launch.  The
+   average with the previous value damps the noise of a single launch.
+  */
+  virtual void report_profiling(const Legion::Mapping::MapperContext,
+    const Legion::Task & task,
+    const Legion::Mapping::Mapper::TaskProfilingInfo & input) {
+    using Realm::ProfilingMeasurements::OperationTimeline;
+    const std::unique_ptr<OperationTimeline> t(
+      input.profiling_responses.get_measurement<OperationTimeline>());
+    if(!t)
+      return;
+    const double s = (t->end_time - t->start_time) * 1e-9;
+    const std::lock_guard guard(costs_mutex);
+    auto & c = costs()[launch(task)].cost;
+    const auto [i, fresh] = c.try_emplace(task.index_point[0], s);
+    if(!fresh)
+      i->second = (i->second + s) / 2;
+  } // report_profiling
+
+  /*!
+   Ask the other processors of this kind that share our memory for work, once
+   any balanced launch has been seen.
+  */
+  virtual void select_steal_targets(const Legion::Mapping::MapperContext,
+    const Legion::Mapping::Mapper::SelectStealingInput & input,
+    Legion::Mapping::Mapper::SelectStealingOutput & output) {
+    if(!stealing || local_kind != Legion::Processor::LOC_PROC)
+      return;
+    const Legion::Memory m = near_memory(local_proc);
+    for(const Legion::Processor p : local_cpus)
+      if(p != local_proc && near_memory(p) == m && !input.blacklist.count(p))
+        output.targets.insert(p);
+  } // select_steal_targets
+
+  /*!
+   Give up one waiting point of a balanced launch to an idle processor.
+  */
+  virtual void permit_steal_request(const Legion::Mapping::MapperContext,
+    const Legion::Mapping::Mapper::StealRequestInput & input,
+    Legion::Mapping::Mapper::StealRequestOutput & output) {
+    for(const Legion::Task * t : input.stealable_tasks)
+      if(t->tag & mapper::balance) {
+        output.stolen_tasks.insert(t);
+        break;
+      }
+  } // permit_steal_request
+
   virtual void map_copy(const Legion::Mapping::MapperContext ctx,
     const Legion::Copy & copy,
     const Legion::Mapping::Mapper::MapCopyInput & input,
@@ -494,6 +587,113 @@ public:
   } // map_copy
 
 private:
+  /*!
+   Assign each point to one of the given processors.  The choice depends only
+   on the point, so that each color uses the same processor (and thus the
+   same memory and instances) in every launch.
+  */
+  static void slice_points(const Legion::Domain & domain,
+    const std::vector<Legion::Processor> & procs,
+    Legion::Mapping::Mapper::SliceTaskOutput & output) {
+    for(Legion::Domain::DomainPointIterator itr(domain); itr; itr++) {
+      Legion::Mapping::Mapper::TaskSlice slice;
+      slice.domain = Legion::Domain(itr.p, itr.p);
+      slice.proc = procs[itr.p[0] % procs.size()];
+      slice.recurse = false;
+      slice.stealable = false;
+      output.slices.push_back(slice);
+    }
+  }
+
+  // The processor preference of a task, without the balance flag.
+  static Legion::MappingTagID kind(const Legion::Task & task) {
+    return task.tag & ~mapper::balance;
+  }
+
+  static bool cost_sliced(const Legion::Task & task) {
+    return kind(task) != mapper::force_rank_match &&
+           (task.tag & mapper::balance || balance_launches_option.value());
+  }
+
+  /*!
+   Assign points to processors so as to equalize their measured times.  Until
+   every point has been measured, use slice_points.  The assignment changes
+   only when the longest-processing-time-first plan shortens the slowest
+   processor's time by 10%, since moving a point means moving its data.
+  */
+  static void slice_by_cost(const Legion::Task & task,
+    const Legion::Domain & domain,
+    const std::vector<Legion::Processor> & procs,
+    Legion::Mapping::Mapper::SliceTaskOutput & output) {
+    if(task.tag & mapper::balance)
+      stealing = true;
+    std::vector<std::pair<double, Legion::coord_t>> work; // (cost, point)
+    std::map<Legion::coord_t, std::size_t> plan;
+    {
+      const std::lock_guard guard(costs_mutex);
+      auto & l = costs()[launch(task)];
+      for(Legion::Domain::DomainPointIterator itr(domain); itr; itr++) {
+        const auto i = l.cost.find(itr.p[0]);
+        if(i == l.cost.end())
+          break;
+        work.emplace_back(i->second, itr.p[0]);
+      }
+      if(work.size() == domain.get_volume()) {
+        const auto n = procs.size();
+        const auto makespan = [n](const auto & w, auto && f) {
+          std::vector<double> load(n);
+          for(auto & [c, p] : w)
+            load[f(p)] += c;
+          return *std::max_element(load.begin(), load.end());
+        };
+        const auto current = [&](Legion::coord_t p) {
+          const auto i = l.plan.find(p);
+          return i == l.plan.end() || i->second >= n ? std::size_t(p % n)
+                                                     : i->second;
+        };
+
+        std::sort(work.begin(), work.end(), std::greater<>());
+        std::vector<double> load(n);
+        std::map<Legion::coord_t, std::size_t> lpt;
+        for(auto & [c, p] : work) {
+          const auto k = std::min_element(load.begin(), load.end());
+          load[k - load.begin()] += c;
+          lpt[p] = k - load.begin();
+        }
+        if(*std::max_element(load.begin(), load.end()) <
+           0.9 * makespan(work, current)) {
+          for(auto & [p, k] : lpt)
+            l.plan[p] = k;
+          flog_devel(info) << "rebalanced " << task.get_task_name() << " over "
+                           << n << " processors" << std::endl;
+        }
+        for(auto & w : work)
+          plan[w.second] = current(w.second);
+      }
+    }
+    if(plan.empty()) {
+      slice_points(domain, procs, output);
+      return;
+    }
+
+    for(Legion::Domain::DomainPointIterator itr(domain); itr; itr++) {
+      Legion::Mapping::Mapper::TaskSlice slice;
+      slice.domain = Legion::Domain(itr.p, itr.p);
+      slice.proc = procs[plan[itr.p[0]]];
+      slice.recurse = false;
+      slice.stealable = task.tag & mapper::balance;
+      output.slices.push_back(slice);
+    }
+  } // slice_by_cost
+
+  /*!
+   Return the host memory nearest to a processor.
+  */
+  Legion::Memory near_memory(Legion::Processor p) const {
+    const auto i = host_memory.find(p);
+    return i == host_memory.end() ? local_sysmem : i->second;
+  }
+
   /*!
    This function will create PhysicalInstance for Reduction task
   */
@@ -584,12 +784,108 @@ private:
     return result;
   }
 
+  // Instance sizes are shared by the mappers of all the local processors,
+  // since several of them may cache the same instance or use one memory.
+  struct shared_instance {
+    std::size_t size = 0;
+    unsigned keys = 0; // entries in local_instances_ of any mapper
+  };
+  struct memory_usage {
+    std::map<Legion::Mapping::PhysicalInstance, shared_instance> instances;
+    std::size_t bytes = 0, peak = 0; // total size of instances
+  };
+  static std::map<Legion::Memory, memory_usage> & usage() {
+    static std::map<Legion::Memory, memory_usage> ret;
+    return ret;
+  }
+  static inline std::mutex usage_mutex;
+
+  /*!
+   Count a new entry in local_instances_ for an instance.  The first entry
+   (in any local mapper) adds the size of the instance to its memory.
+  */
+  void hold(const Legion::Mapping::MapperContext ctx,
+    Legion::Memory m,
+    const Legion::Mapping::PhysicalInstance & i) {
+    const std::lock_guard guard(usage_mutex);
+    memory_usage & u = usage()[m];
+    shared_instance & s = u.instances[i];
+    if(!s.keys++) {
+      s.size = i.get_instance_size();
+      // It may have been found just after another mapper released it.
+      runtime->set_garbage_collection_priority(ctx, i, GC_NEVER_PRIORITY);
+      u.bytes += s.size;
+      report(m, u, false);
+    }
+  }
+
+  /*!
+   Drop the least recently used entries in local_instances_ for a memory,
+   except those used by the task being mapped, until the memory is within
+   the instance budget.  An instance is released when no entry in any local
+   mapper refers to it; Legion collects it once it is no longer needed.
+  */
+  void evict(const Legion::Mapping::MapperContext ctx, Legion::Memory m) {
+    const std::size_t budget =
+      std::size_t(instance_budget_option.value()) << 20;
+    if(!budget)
+      return;
+    const std::lock_guard guard(usage_mutex);
+    memory_usage & u = usage()[m];
+    bool released = false;
+    while(u.bytes > budget) {
+      instance_map_t::iterator oldest_region;
+      field_instance_map_t::iterator oldest;
+      bool found = false;
+      for(auto i = local_instances_.begin(); i != local_instances_.end(); ++i)
+        if(i->first.second == m)
+          for(auto j = i->second.begin(); j != i->second.end(); ++j)
+            if(j->second.last_use < clock &&
+               (!found || j->second.last_use < oldest->second.last_use)) {
+              oldest_region = i;
+              oldest = j;
+              found = true;
+            }
+      if(!found)
+        break;
+      const auto s = u.instances.find(oldest->second.instance);
+      if(!--s->second.keys) {
+        runtime->set_garbage_collection_priority(
+          ctx, s->first, GC_FIRST_PRIORITY);
+        u.bytes -= s->second.size;
+        u.instances.erase(s);
+        released = true;
+      }
+      oldest_region->second.erase(oldest);
+      if(oldest_region->second.empty())
+        local_instances_.erase(oldest_region);
+    }
+    if(released)
+      report(m, u, true);
+  }
+
+  // Report the instance bytes in a memory if requested and interesting.
+  static void report(Legion::Memory m, memory_usage & u, bool released) {
+    if(!instance_report_option.value())
+      return;
+    if(u.bytes > u.peak || released) {
+      u.peak = std::max(u.peak, u.bytes);
+      flog(info) << "memory " << m.id << " holds " << u.bytes
+                 << " bytes of instances"
+                 << (released ? " after releasing some" : "") << std::endl;
+    }
+  }
+
   Realm::Machine machine;
 
   // the map of the locac intances that have been already created
   // the first key is the pair of Logical region and Memory that is
   // used as an identifier for the instance, second key is fid
-  typedef std::map<std::set<Legion::FieldID>, Legion::Mapping::PhysicalInstance>
+  struct cached_instance {
+    Legion::Mapping::PhysicalInstance instance;
+    std::uint64_t last_use = 0; // the value of clock
+  };
+  typedef std::map<std::set<Legion::FieldID>, cached_instance>
     field_instance_map_t;
 
   typedef std::map<std::pair<Legion::LogicalRegion, Legion::Memory>,
@@ -597,6 +893,34 @@ private:
     instance_map_t;
 
   instance_map_t local_instances_;
+  // The number of map_task calls so far
+  std::uint64_t clock = 0;
+
+  // Measured costs are shared by the mappers of all the local processors,
+  // since the one that slices a launch is not the one that maps its points.
+  // A task's launches over different domains or data have unrelated costs,
+  // so they are identified also by the index domain and by the parent region
+  // and projection functor of each region requirement.
+  using launch_key = std::tuple<Legion::TaskID,
+    Legion::Domain,
+    std::vector<std::pair<Legion::LogicalRegion, Legion::ProjectionID>>>;
+  static launch_key launch(const Legion::Task & task) {
+    launch_key ret{task.task_id, task.index_domain, {}};
+    for(auto & r : task.regions)
+      std::get<2>(ret).emplace_back(r.parent, r.projection);
+    return ret;
+  }
+  struct launch_costs {
+    std::map<Legion::coord_t, double> cost; // seconds for each point
+    std::map<Legion::coord_t, std::size_t> plan; // processor index
+  };
+  static std::map<launch_key, launch_costs> & costs() {
+    static std::map<launch_key, launch_costs> ret;
+    return ret;
+  }
+  static inline std::mutex costs_mutex;
+  // Whether any balanced launch has been sliced
+  static inline std::atomic<bool> stealing{false};
 
 protected:
   std::map<Legion::TaskID, Legion::VariantID> cpu_variants;
@@ -604,6 +928,8 @@ protected:
   std::map<Legion::TaskID, Legion::VariantID> omp_variants;
 
   Legion::Memory local_sysmem, local_zerocopy, local_framebuffer;
+  // The socket memory (or local_sysmem) for each local CPU or OpenMP processor
+  std::map<Legion::Processor, Legion::Memory> host_memory;
 };
 
 /*!
@@ -1,6 +1,8 @@
 #include "flecsi/run/mpi/context.hh"
 #include "flecsi/data.hh"
 
+#include <algorithm>
+
 #if defined(FLECSI_ENABLE_KOKKOS)
 #include <Kokkos_Core.hpp>
 #endif
@@ -27,7 +29,20 @@ dependencies_guard::~dependencies_guard() {
 }
 
 context_t::context_t(const arguments::config & c)
-  : context(c, util::mpi::size(), util::mpi::rank()) {}
+  : context(c, util::mpi::size(), util::mpi::rank()),
+    node_(util::mpi::comm::shared(MPI_COMM_WORLD)) {}
+
+context_t::node_window &
+context_t::window(std::size_t type_size, std::size_t n) {
+  auto & w = windows[type_size];
+  if(!w || w->memory.size() < n) {
+    // Grow geometrically to replace the memory (collectively) only rarely.
+    n = std::max(n, w ? 2 * w->memory.size() : 0);
+    w.reset(); // after the peers have finished with it
+    w = std::make_unique<node_window>(node_.c, n);
+  }
+  return *w;
+}
 
 //----------------------------------------------------------------------------//
 // Implementation of context_t::start.
@@ -40,7 +55,9 @@ context_t::start(const std::function<int()> & action) {
   context::threads_per_process_ = 1;
   context::threads_ = context::processes_;
 
-  return detail::data_guard(), task_local_base::guard(), action();
+  const int ret = (detail::data_guard(), task_local_base::guard(), action());
+  util::profile::report();
+  return ret;
 }
 
 } // namespace flecsi::run
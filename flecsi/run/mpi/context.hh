@@ -10,7 +10,10 @@
 #include <boost/program_options.hpp>
 #include <mpi.h>
 
+#include <deque>
 #include <map>
+#include <memory>
+#include <utility>
 
 namespace flecsi {
 namespace run {
@@ -56,7 +59,7 @@ struct context_t : context {
    */
 
   Color color() const {
-    return process_;
+    return point.colors ? point.color : process_;
   }
 
   /*
@@ -64,10 +67,64 @@ struct context_t : context {
    */
 
   Color colors() const {
-    return processes_;
+    return point.colors ? point.colors : processes_;
   }
 
-  static inline int depth;
+  /*
+    Return the first of the colors held by this process when there are \a n
+    in all, and how many there are.  When \a n is a multiple of the number of
+    processes, each holds a contiguous block of them; otherwise, each holds
+    just its own row.
+   */
+
+  std::pair<Color, Color> local_colors(Color n) const {
+    if(n <= processes_ || n % processes_)
+      return {process_, 1};
+    const Color k = n / processes_;
+    return {process_ * k, k};
+  }
+
+  /*
+    Return the position of the current point task among the colors held by
+    this process, or 0 outside of an index launch with several of them.
+   */
+
+  static Color local_color() {
+    return point.local;
+  }
+
+  /*
+    Return the processes that can share memory with this one, in the order of
+    \c MPI_COMM_WORLD.
+   */
+
+  MPI_Comm node() const {
+    return node_.c;
+  }
+
+  /*
+    Memory shared on the node, in which each process uses the two halves of
+    its segment alternately.  The requests that must complete before a half is
+    written again are kept with it.
+   */
+
+  struct node_window {
+    node_window(MPI_Comm c, std::size_t n) : memory(c, n) {}
+
+    util::mpi::shared_memory memory;
+    bool parity = false; // which half is in use
+    util::mpi::auto_requests pending[2];
+  };
+
+  /*
+    Return the node_window for values of \a type_size bytes, replacing it if
+    its segments are smaller than \a n bytes.  Collective on the node; each
+    process must supply the same arguments.
+   */
+
+  node_window & window(std::size_t type_size, std::size_t n);
+
+  static inline thread_local int depth;
 
   struct depth_guard {
     depth_guard() {
@@ -77,6 +134,30 @@ struct context_t : context {
       --depth;
     }
   };
+
+private:
+  struct launch_point {
+    Color color, colors, local; // colors == 0 if not selected
+  };
+  static inline thread_local launch_point point{};
+
+  util::mpi::comm node_;
+  std::map<std::size_t, std::unique_ptr<node_window>> windows; // by type size
+
+public:
+  // Select one of several colors of an index launch on the calling thread.
+  struct color_guard {
+    color_guard(Color c, Color n, Color i) : old(point) {
+      point = {c, n, i};
+    }
+    color_guard(color_guard &&) = delete;
+    ~color_guard() {
+      point = old;
+    }
+
+  private:
+    launch_point old;
+  };
 };
 
 /// \}
@@ -100,10 +181,17 @@ private:
   }
 
   std::optional<T> & cur() {
-    return run::context_t::task_depth() ? task : outer;
+    if(!run::context_t::task_depth())
+      return outer;
+    // Only the launching thread creates values, so growth is not concurrent.
+    const Color i = run::context_t::local_color();
+    if(i >= task.size())
+      task.resize(i + 1);
+    return task[i];
   }
 
-  std::optional<T> outer, task;
+  std::optional<T> outer;
+  std::deque<std::optional<T>> task; // for each local color
 };
 
 } // namespace flecsi
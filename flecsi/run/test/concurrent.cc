@@ -0,0 +1,146 @@
+#include "flecsi/execution.hh"
+#include "flecsi/runtime.hh"
+#include "flecsi/util/unit.hh"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace flecsi;
+
+struct diamond_policy : run::control_base {
+  enum control_points_enum { advance };
+  using control_points = list<point<advance>>;
+  struct node_policy {};
+
+  std::vector<char> order;
+  std::mutex mutex;
+  std::atomic<int> arrived{0};
+  bool met[2] = {};
+
+  void record(char c) {
+    std::lock_guard l(mutex);
+    order.push_back(c);
+  }
+};
+
+inline const char *
+operator*(diamond_policy::control_points_enum) {
+  return "advance";
+}
+
+using diamond = run::control<diamond_policy>;
+
+// Wait (briefly) for the other branch to arrive, which can happen only if
+// the two are executed concurrently.
+template<int I>
+void
+branch(diamond_policy & p) {
+  p.record('b' + I);
+  ++p.arrived;
+  const auto end =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+  while(p.arrived < 2 && std::chrono::steady_clock::now() < end)
+    std::this_thread::yield();
+  p.met[I] = p.arrived == 2;
+}
+
+void
+top(diamond_policy & p) {
+  p.record('a');
+}
+
+void
+bottom(diamond_policy & p) {
+  if(p.order.size() != 3 || p.order.front() != 'a')
+    throw run::control_base::exception{2};
+  if(!p.met[0] || !p.met[1])
+    throw run::control_base::exception{1};
+}
+
+diamond::action<top, diamond_policy::advance> top_action;
+diamond::action<branch<0>, diamond_policy::advance> left_action;
+diamond::action<branch<1>, diamond_policy::advance> right_action;
+diamond::action<bottom, diamond_policy::advance> bottom_action;
+const auto dep_left = left_action.add(top_action);
+const auto dep_right = right_action.add(top_action);
+const auto dep_bottom_left = bottom_action.add(left_action);
+const auto dep_bottom_right = bottom_action.add(right_action);
+
+// Two independent actions that each launch tasks.  The launches must be
+// ordered alike on every process even when the actions are concurrent.
+struct launch_policy : run::control_base {
+  enum control_points_enum { launch };
+  using control_points = list<point<launch>>;
+  struct node_policy {};
+
+  bool ok[2] = {};
+};
+
+inline const char *
+operator*(launch_policy::control_points_enum) {
+  return "launch";
+}
+
+using launcher = run::control<launch_policy>;
+
+template<int I>
+int
+value() {
+  return I;
+}
+
+int
+offset(int a, exec::launch_domain) {
+  return a + color();
+}
+
+template<int I>
+void
+launching(launch_policy & p) {
+  // Each broadcast and reduction would receive another action's values if
+  // the processes ordered the launches differently.
+  const int n = processes();
+  const exec::launch_domain ld{Color(n)};
+  bool ok = true;
+  for(int i = 0; i < 10; ++i) {
+    const int a = I + 2 * i;
+    ok = ok && execute<value<I>>().get() == I &&
+         reduce<offset, exec::fold::sum>(a, ld).get() ==
+           a * n + n * (n - 1) / 2;
+  }
+  p.ok[I] = ok;
+}
+
+void
+launched(launch_policy & p) {
+  if(!p.ok[0] || !p.ok[1])
+    throw run::control_base::exception{1};
+}
+
+launcher::action<launching<0>, launch_policy::launch> launch0_action;
+launcher::action<launching<1>, launch_policy::launch> launch1_action;
+launcher::action<launched, launch_policy::launch> launched_action;
+const auto dep_launched0 = launched_action.add(launch0_action);
+const auto dep_launched1 = launched_action.add(launch1_action);
+
+int
+concurrent() {
+  UNIT() {
+#if FLECSI_BACKEND == FLECSI_BACKEND_mpi
+    const bool threaded = run::control_threads_option.value() > 1;
+#else
+    const bool threaded = false;
+#endif
+    // Without concurrency, the branches cannot meet.
+    EXPECT_EQ(diamond::invoke(), threaded ? 0 : 1);
+    // The cached order is reused.
+    EXPECT_EQ(diamond::invoke(), threaded ? 0 : 1);
+    // Actions executed concurrently may launch tasks.
+    EXPECT_EQ(launcher::invoke(), 0);
+  };
+} // concurrent
+
+util::unit::driver<concurrent> driver;
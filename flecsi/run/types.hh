@@ -8,11 +8,14 @@
 #include "flecsi/flog.hh"
 #include "flecsi/util/constant.hh"
 #include "flecsi/util/dag.hh"
+#include "flecsi/util/pool.hh"
 
 #if defined(FLECSI_ENABLE_GRAPHVIZ)
 #include "flecsi/util/graphviz.hh"
 #endif
 
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 
 /// \cond core
@@ -145,22 +148,78 @@ private:
 
 }; // struct init_walker
 
+/*
+  The order in which the actions of a level that are executed concurrently
+  launch tasks.  A launch updates runtime state shared by all actions and may
+  post collective operations, which must be ordered alike on every process,
+  so each action waits to launch until those before it in the sorted level
+  have finished.  The threads of a util::thread_pool start the actions in
+  order, so the first unfinished action is always running and never waits.
+ */
+struct launch_order {
+  explicit launch_order(std::size_t n) : done(n) {}
+
+  // Wait until action i may launch tasks.
+  void wait(std::size_t i) {
+    std::unique_lock l(mutex);
+    turn.wait(l, [&] { return next == i; });
+  }
+  // Record that action i has finished.
+  void finish(std::size_t i) {
+    {
+      std::lock_guard l(mutex);
+      done[i] = true;
+      while(next < done.size() && done[next])
+        ++next;
+    }
+    turn.notify_all();
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable turn;
+  std::vector<bool> done;
+  std::size_t next = 0;
+};
+
+/*
+  The level and position of the action that the calling thread is executing
+  concurrently with others, if any.
+ */
+inline thread_local struct {
+  launch_order * order;
+  std::size_t index;
+} concurrent_action{};
+
+/*
+  Wait until the calling thread may launch a task.
+ */
+inline void
+launch_turn() {
+  if(auto * const o = concurrent_action.order)
+    o->wait(concurrent_action.index);
+}
+
 /*!
   The point_walker class allows execution of statically-defined
-  control points.
+  control points.  The actions at each control point are executed level by
+  level; if a \c util::thread_pool is supplied, the actions within a level
+  are executed concurrently and launch tasks in their sorted order.
  */
 
 template<typename P>
 struct point_walker {
 
   using control_points_enum = typename P::control_points_enum;
-  using sorted_type = typename P::sorted_type;
+  using schedule_type = typename P::schedule_type;
   using policy_type = typename P::policy_type;
 
-  point_walker(const sorted_type & sorted,
+  point_walker(const schedule_type & schedule,
     int & exit_status,
-    policy_type * policy = nullptr)
-    : sorted_(sorted), exit_status_(exit_status), policy_(policy) {}
+    policy_type * policy = nullptr,
+    util::thread_pool * pool = nullptr)
+    : schedule_(schedule), exit_status_(exit_status), policy_(policy),
+      pool_(pool) {}
 
   /*!
     Handle the tuple type \em ElementType.
@@ -178,11 +237,36 @@ struct point_walker {
                    control_points_enum>::value) {
 
       // This is not a cycle -> execute each action for this control point.
-      for(auto & node : sorted_.at(ElementType::value)) {
-        if constexpr(P::is_control_base_policy)
-          node->execute(policy_);
-        else
-          exit_status_ |= node->execute(policy_);
+      for(auto & level : schedule_.at(ElementType::value)) {
+        if(pool_ && level.size() > 1) {
+          std::vector<int> status(level.size());
+          launch_order order(level.size());
+          (*pool_)(level.size(), [&](std::size_t i) {
+            struct guard {
+              guard(launch_order & o, std::size_t i) {
+                concurrent_action = {&o, i};
+              }
+              ~guard() {
+                concurrent_action.order->finish(concurrent_action.index);
+                concurrent_action = {};
+              }
+            } g(order, i);
+            if constexpr(P::is_control_base_policy)
+              level[i]->execute(policy_);
+            else
+              status[i] = level[i]->execute(policy_);
+          });
+          for(auto s : status)
+            exit_status_ |= s;
+        }
+        else {
+          for(auto & node : level) {
+            if constexpr(P::is_control_base_policy)
+              node->execute(policy_);
+            else
+              exit_status_ |= node->execute(policy_);
+          } // for
+        } // if
       } // for
     }
     else {
@@ -195,16 +279,17 @@ struct point_walker {
           return ElementType::predicate();
       };
       while(test()) {
-        point_walker walker(sorted_, exit_status_, policy_);
+        point_walker walker(schedule_, exit_status_, policy_, pool_);
         walk<typename ElementType::type>(walker);
       } // while
     } // if
   } // visit_type
 
 private:
-  const sorted_type & sorted_;
+  const schedule_type & schedule_;
   int & exit_status_;
   policy_type * policy_;
+  util::thread_pool * pool_;
 }; // struct point_walker
 
 #if defined(FLECSI_ENABLE_GRAPHVIZ)
@@ -16,7 +16,10 @@
 #include "flecsi/topo/types.hh"
 #include "flecsi/util/array_ref.hh"
 
+#include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <utility>
 
 namespace flecsi {
@@ -84,7 +87,83 @@ struct narray : narray_base, with_ragged<Policy>, with_meta<Policy> {
         f, meta_field(this->meta));
     }
     else
-      plan_.template get<Space>().issue_copy(f.fid());
+      plan_.template get<Space>()->issue_copy(f.fid());
+    valid_.template get<Space>()[f.fid()] = halo_.template get<Space>();
+  }
+
+  /*!
+    Prepare a stencil sweep that reads the ghosts of \a in and computes \a out
+    redundantly into its own ghosts.  With a deep halo (an \c hdepth that is a
+    multiple \em k of the stencil depth), \em k consecutive sweeps need only
+    one ghost copy: the copy plan for \a in is issued only if fewer than \a w
+    of its ghost layers are still current.
+
+    Pass the result to the task and iterate over \c range(d) there; the task
+    must write \a out with ghost privileges (e.g., \c wo, \c wo).  Only the
+    returned number of ghost layers of \a out are then current, so further
+    stencils on it should also go through this function.
+
+    \param w stencil depth (ghost layers consumed by one sweep)
+    \return the number of ghost layers of \a out that can be computed
+   */
+  template<typename T,
+    data::layout L,
+    typename Policy::index_space Space,
+    typename U,
+    data::layout M>
+  util::id sweep(data::field_reference<T, L, Policy, Space> const & in,
+    data::field_reference<U, M, Policy, Space> const & out,
+    util::id w = 1) {
+    static_assert(Policy::template privilege_count<Space> > 1,
+      "index space has no ghosts");
+    auto & v = valid_.template get<Space>();
+    // A pending ordinary ghost update invalidates all layers.
+    if(get_region<Space>().template ghost<privilege_pack<ro, ro>>(in.fid()) ||
+       v[in.fid()] < w)
+      ghost_copy(in);
+    const util::id d = v[in.fid()];
+    flog_assert(d >= w, "stencil depth " << w << " exceeds halo depth " << d);
+    return v[out.fid()] = d - w;
+  }
+
+  /*!
+    Redistribute the index points among the colors to balance the given cost,
+    moving the field data accordingly.  Each axis is divided anew by
+    \c index_definition::rebalanced according to the first index space; the
+    other index spaces (typically auxiliaries) must share its colormaps and
+    are divided identically.  It is an error for any ragged field to hold
+    data.
+
+    \param cost measured cost of each color (\em e.g., the time spent by a
+      task on it)
+   */
+  void rebalance(const std::vector<double> & cost) {
+    const auto & primary = coloring_.idx_colorings.front();
+    const auto b = primary.rebalanced(cost);
+    coloring c = coloring_;
+    for(auto & idef : c.idx_colorings)
+      for(Dimension d = 0; d < dimension; ++d) {
+        flog_assert(idef.axes[d].colormap.ends() ==
+                      primary.axes[d].colormap.ends(),
+          "index spaces must share colormaps to be rebalanced");
+        idef.axes[d].colormap = b.axes[d].colormap;
+      }
+    redistribute(c);
+  }
+
+  /*!
+    Move the field data to a new coloring.  Each index space must have the
+    same number of colors and index points along each axis as before.  Every
+    color receives all its points (including ghosts) from their owners, then
+    the copy plans are rebuilt.  Ragged (and thus sparse) fields are not
+    migrated, so it is an error for any of them to hold data.
+   */
+  void redistribute(coloring const & c) {
+    flog_assert(c.idx_colorings.size() == index_spaces::size,
+      c.idx_colorings.size()
+        << " sizes for " << index_spaces::size << " index spaces");
+    redistribute(
+      c, index_spaces(), std::make_index_sequence<index_spaces::size>());
   }
 
 private:
@@ -108,11 +187,12 @@ private:
           concatenate(partitions, c.colors(), MPI_COMM_WORLD);
           return partitions;
         }()))...}},
-      plan_{{make_copy_plan<Value>(c.colors(),
-        c.idx_colorings[Index],
-        part_[Index])...}},
       buffers_{{data::buffers::core(
-        narray_impl::peers<dimension>(c.idx_colorings[Index]))...}} {
+        narray_impl::peers<dimension>(c.idx_colorings[Index]),
+        data::buffers::ragged::pages)...}},
+      halo_{{c.idx_colorings[Index].halo()...}}, coloring_(c) {
+    (make_copy_plan<Value>(c.colors(), c.idx_colorings[Index], part_[Index]),
+      ...);
     auto lm = data::launch::make(this->meta);
     execute<set_meta<Value...>, mpi>(meta_field(lm), c);
     init_policy_meta(c);
@@ -125,7 +205,7 @@ private:
    @param p partition
   */
   template<index_space S>
-  data::copy_plan make_copy_plan(Color colors,
+  void make_copy_plan(Color colors,
     index_definition const & idef,
     repartitioned & p) {
 
@@ -159,7 +239,111 @@ private:
     };
     // clang-format on
 
-    return {*this, p, num_intervals, dest_task, ptrs_task, util::constant<S>()};
+    plan_.template get<S>().emplace(
+      *this, p, num_intervals, dest_task, ptrs_task, util::constant<S>());
+  }
+
+  template<auto... Value, std::size_t... Index>
+  void redistribute(const coloring & c,
+    util::constants<Value...> /* index spaces to deduce pack */,
+    std::index_sequence<Index...>) {
+    (check_ragged<Value>(), ...);
+    (migrate<Value>(coloring_.idx_colorings[Index], c.idx_colorings[Index]),
+      ...);
+    (make_copy_plan<Value>(c.colors(), c.idx_colorings[Index], part_[Index]),
+      ...);
+    auto lm = data::launch::make(this->meta);
+    execute<set_meta<Value...>, mpi>(meta_field(lm), c);
+    for(auto & v : valid_)
+      v.clear();
+    coloring_ = c;
+  }
+
+  // Stop if a ragged field of an index space holds data, which could not be
+  // migrated.
+  template<index_space S>
+  void check_ragged() {
+    for(const auto & fi : run::context::field_info_store<ragged<Policy>, S>())
+      if(reduce<occupied<Policy::template privilege_count<S>>,
+           exec::fold::max>(
+           data::field_reference<std::size_t, data::raw, Policy, S>(
+             fi->fid, *this))
+           .get())
+        flog_fatal("cannot redistribute index space "
+                   << S << " while a ragged field (" << fi->name
+                   << ") holds data");
+  }
+
+  /*!
+   Method to move the data of an index-space to a new index definition.
+   The partition is first enlarged so that a copy plan can append the new
+   layout of each color to the old one; the result is then moved to the front.
+   Ragged fields are not migrated; their (empty) rows are reset.
+   @param from current index definition
+   @param to new index definition
+  */
+  template<index_space S>
+  void migrate(index_definition const & from, index_definition const & to) {
+    const Color n = colors();
+    std::vector<std::size_t> from_sz, to_sz, both;
+    for(Color c = 0; c < n; ++c) {
+      from_sz.push_back(from.make_color(from.color_indices(c)).extents());
+      to_sz.push_back(to.make_color(to.color_indices(c)).extents());
+      both.push_back(from_sz.back() + to_sz.back());
+    }
+    auto & p = part_.template get<S>();
+    p.resize(make_partial<idx_size>(both));
+
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> intervals;
+    std::vector<index_color::points> points;
+    for(const auto & idxco : to.process_coloring()) {
+      const Color c = idxco.color();
+      intervals.push_back({{from_sz[c], both[c]}});
+      points.push_back(to.sources(from, c, from_sz[c]));
+    }
+
+    // clang-format off
+    auto dest_task = [&intervals](auto f) {
+      auto lm = data::launch::make(f.topology());
+      execute<set_dests, mpi>(lm(f), intervals);
+    };
+
+    auto ptrs_task = [&points](auto f) {
+      auto lm = data::launch::make(f.topology());
+      execute<set_ptrs<Policy::template privilege_count<S>>, mpi>(
+        lm(f), points);
+    };
+    // clang-format on
+
+    const data::copy_plan plan(*this,
+      p,
+      data::copy_plan::Sizes(n, 1),
+      dest_task,
+      ptrs_task,
+      util::constant<S>());
+
+    // The copy plan's own field and ragged offsets are not migrated; the
+    // latter are reset below since they cannot describe the new layout.
+    std::set<field_id_t> skip{data::copy_plan::get_field_id<Policy, S>()};
+    const auto & rfs = run::context::field_info_store<ragged<Policy>, S>();
+    for(const auto & fi : rfs)
+      skip.insert(fi->fid);
+    for(const auto & fi : run::context::field_info_store<Policy, S>())
+      if(!skip.count(fi->fid)) {
+        plan.issue_copy(fi->fid);
+        execute<shift<Policy::template privilege_count<S>>>(
+          data::field_reference<std::byte, data::raw, Policy, S>(
+            fi->fid, *this),
+          from_sz,
+          to_sz,
+          fi->type_size);
+      }
+
+    p.resize(make_partial<idx_size>(to_sz));
+    for(const auto & fi : rfs)
+      execute<clear<Policy::template privilege_count<S>>>(
+        data::field_reference<std::size_t, data::raw, Policy, S>(
+          fi->fid, *this));
   }
 
   template<auto... Value> // index_spaces
@@ -470,12 +654,21 @@ private:
   util::key_array<repartitioned, index_spaces> part_;
 
   // index-space specific copy plans
-  util::key_array<data::copy_plan, index_spaces> plan_;
+  util::key_array<std::optional<data::copy_plan>, index_spaces> plan_;
 
   // This key_array of buffers core objects are needed to transfer
   // ragged data. We have a key array over index_spaces because
   // each index_space possibly may have a different communication graph.
   util::key_array<data::buffers::core, index_spaces> buffers_;
+
+  // ghost layers available on every side with neighbors, per index-space
+  util::key_array<util::id, index_spaces> halo_;
+
+  // ghost layers that are still current, per index-space and field
+  util::key_array<std::map<field_id_t, util::id>, index_spaces> valid_;
+
+  // current coloring, for redistribution
+  coloring coloring_;
 }; // struct narray
 
 template<class P>
@@ -727,6 +920,25 @@ protected:
     }
   }
 
+  /*!
+     Method to return an iterator over the logical entities of index space S
+     along axis A widened by up to \a d ghost (or periodic boundary) layers on
+     each side that has them.  With the depth returned by \c narray::sweep,
+     this is the range on which a stencil's inputs are still current.
+     This function is \ref topology "host-accessible".
+   */
+  template<index_space S, axis A>
+  FLECSI_INLINE_TARGET auto range(util::id d) const {
+    auto & ax = get_axis<S, A>();
+    const auto halo = [&](bool end) -> util::id {
+      const util::id n = end ? ax.periodic ? ax.bdepth : 0 : ax.hdepth;
+      return d < n ? d : n;
+    };
+    return make_ids<S>(util::iota_view<util::id>(
+      logical<S, A, 0>() - halo(ax.is_low()),
+      logical<S, A, 1>() + halo(ax.is_high())));
+  }
+
   /*!
     Method to return an offset of \c S along \c A for \a DM.
     This function is \ref topology "host-accessible".
@@ -945,6 +945,98 @@ check_contiguous(data::multi<mesh1d::accessor<ro>> mm) {
   };
 }
 
+const field<std::size_t>::definition<mesh1d> h1a, h1b;
+// With Legion, the halo sweeps map both fields into one instance.
+const field_group halo(h1a, h1b);
+
+void
+init_halo(mesh1d::accessor<ro> m, field<std::size_t>::accessor<wo, na> ua) {
+  auto u = m.mdspan<topo::elements>(ua);
+  for(auto i : m.range<mesh1d::axis::x_axis>())
+    u[i] = m.global_id<mesh1d::axis::x_axis>(i);
+}
+
+// A maximum filter, which is exact only if every input it reads is current.
+void
+sweep_halo(mesh1d::accessor<ro> m,
+  field<std::size_t>::accessor<ro, ro> ua,
+  field<std::size_t>::accessor<wo, wo> va,
+  util::id d) {
+  auto u = m.mdspan<topo::elements>(ua);
+  auto v = m.mdspan<topo::elements>(va);
+  const util::id n = m.size<mesh1d::axis::x_axis, mesh1d::domain::all>();
+  for(auto i : m.range<mesh1d::axis::x_axis>(d))
+    v[i] = std::max({u[i ? i - 1 : i], u[i], u[i + 1 < n ? i + 1 : i]});
+}
+
+int
+check_halo(mesh1d::accessor<ro> m,
+  field<std::size_t>::accessor<ro, na> ua,
+  std::size_t sweeps) {
+  UNIT("TASK") {
+    auto u = m.mdspan<topo::elements>(ua);
+    const auto n = m.size<mesh1d::axis::x_axis, mesh1d::domain::global>();
+    for(auto i : m.range<mesh1d::axis::x_axis>()) {
+      const auto g = m.global_id<mesh1d::axis::x_axis>(i);
+      EXPECT_EQ(u[i], std::min<std::size_t>(g + sweeps, n - 1));
+    }
+  };
+}
+
+const field<double>::definition<mesh2d> rb2;
+const ints::definition<mesh2d> rr2;
+
+void
+init_rebalance(mesh2d::accessor<ro> m,
+  field<double>::accessor<wo, na> ua,
+  double base) {
+  auto u = m.mdspan<topo::elements>(ua);
+  for(auto j : m.range<mesh2d::axis::y_axis>()) {
+    for(auto i : m.range<mesh2d::axis::x_axis>()) {
+      u[j][i] = base + m.global_id<mesh2d::axis::x_axis>(i) +
+                100 * m.global_id<mesh2d::axis::y_axis>(j);
+    }
+  }
+}
+
+int
+check_rebalance(mesh2d::accessor<ro> m,
+  field<double>::accessor<ro, ro> ua,
+  double base,
+  std::vector<util::id> const & sizes) {
+  UNIT("TASK") {
+    EXPECT_EQ(m.size<mesh2d::axis::x_axis>(), sizes[color() % 2]);
+    EXPECT_EQ(m.size<mesh2d::axis::y_axis>(), sizes[color() / 2]);
+    // With periodic axes and diagonals, every point is owned or a ghost.
+    auto u = m.mdspan<topo::elements>(ua);
+    for(auto j : m.range<mesh2d::axis::y_axis, mesh2d::domain::all>()) {
+      for(auto i : m.range<mesh2d::axis::x_axis, mesh2d::domain::all>()) {
+        EXPECT_EQ(u[j][i],
+          base + m.global_id<mesh2d::axis::x_axis>(i) +
+            100 * m.global_id<mesh2d::axis::y_axis>(j));
+      }
+    }
+  };
+}
+
+void
+init_rows(ints::mutator<wo, na> r) {
+  for(std::size_t i = 0; i < r.size(); ++i)
+    r[i].push_back(int(i));
+}
+
+int
+check_rows(ints::accessor<ro, na> r, bool filled) {
+  UNIT("TASK") {
+    for(std::size_t i = 0; i < r.size(); ++i) {
+      ASSERT_EQ(r[i].size(), std::size_t(filled));
+      if(filled) {
+        EXPECT_EQ(r[i][0], int(i));
+      }
+    }
+  };
+}
+
 int
 check_4dmesh(mesh4d::accessor<ro> m) {
   UNIT("TASK") {
@@ -1119,6 +1211,82 @@ narray_driver() {
 
     } // scope
 
+    {
+      // Deep halo: two sweeps per ghost copy
+      mesh1d::slot m1;
+
+      mesh1d::index_definition idef;
+      idef.axes = mesh1d::base::make_axes(processes(), {16});
+      idef.axes[0].hdepth = 2;
+
+      m1.allocate(mesh1d::mpi_coloring(idef));
+      execute<init_halo>(m1, h1a(m1));
+      auto * in = &h1a;
+      auto * out = &h1b;
+      std::vector<util::id> depths;
+      for(int s = 0; s < 5; ++s, std::swap(in, out)) {
+        const auto d = m1->sweep((*in)(m1), (*out)(m1));
+        depths.push_back(d);
+        execute<sweep_halo>(m1, (*in)(m1), (*out)(m1), d);
+      }
+      EXPECT_EQ(depths, (std::vector<util::id>{1, 0, 1, 0, 1}));
+      EXPECT_EQ(test<check_halo>(m1, (*in)(m1), 5), 0);
+    } // scope
+
+    {
+      // Over-decomposition: several colors per process
+      mesh1d::slot m1;
+
+      mesh1d::index_definition idef;
+      idef.axes = mesh1d::base::make_axes(2 * processes(), {32});
+      idef.axes[0].hdepth = 1;
+
+      m1.allocate(mesh1d::mpi_coloring(idef));
+      EXPECT_EQ(m1->colors(), 2 * processes());
+      execute<init_halo>(m1, h1a(m1));
+      auto * in = &h1a;
+      auto * out = &h1b;
+      for(int s = 0; s < 3; ++s, std::swap(in, out))
+        execute<sweep_halo>(
+          m1, (*in)(m1), (*out)(m1), m1->sweep((*in)(m1), (*out)(m1)));
+      EXPECT_EQ(test<check_halo>(m1, (*in)(m1), 3), 0);
+    } // scope
+
+    {
+      // Rebalancing: color 0 is three times as expensive as the others
+      using ids = std::vector<util::id>;
+      mesh2d::slot m2;
+
+      mesh2d::index_definition idef;
+      idef.axes = mesh2d::base::make_axes(processes(), {16, 16});
+      for(auto & a : idef.axes) {
+        a.hdepth = 1;
+        a.bdepth = 1;
+        a.periodic = true;
+      }
+      idef.diagonals = true;
+
+      m2.allocate(mesh2d::mpi_coloring(idef));
+      execute<init_rebalance>(m2, rb2(m2), 0.0);
+      execute<allocate_field<2>>(f2(m2), rr2(m2).get_elements().sizes(), 1);
+      EXPECT_EQ(test<check_rebalance>(m2, rb2(m2), 0.0, ids{8, 8}), 0);
+
+      // Ragged fields are not migrated, but they may exist if they are
+      // empty (see narray_ragged for the error otherwise).
+      std::vector<double> cost(m2->colors(), 1);
+      cost[0] = 3;
+      m2->rebalance(cost);
+      EXPECT_EQ(test<check_rebalance>(m2, rb2(m2), 0.0, ids{6, 10}), 0);
+      EXPECT_EQ(test<check_rows>(rr2(m2), false), 0);
+      execute<allocate_field<2>>(f2(m2), rr2(m2).get_elements().sizes(), 1);
+      execute<init_rows>(rr2(m2));
+      EXPECT_EQ(test<check_rows>(rr2(m2), true), 0);
+
+      // The ghost copy plan follows the new layout.
+      execute<init_rebalance>(m2, rb2(m2), 1000.0);
+      EXPECT_EQ(test<check_rebalance>(m2, rb2(m2), 1000.0, ids{6, 10}), 0);
+    } // scope
+
     {
       // 2D Mesh
       auto test_2d = [](const mesh2d::gcoord & indices,
@@ -78,6 +78,11 @@ struct mesh : flecsi::topo::specialization<flecsi::topo::narray, mesh<D>>,
       return B::template range<flecsi::topo::elements, A, DM>();
     }
 
+    template<axis A>
+    auto range(flecsi::util::id d) const {
+      return B::template range<flecsi::topo::elements, A>(d);
+    }
+
     template<axis A, domain DM = domain::logical>
     auto offset() const {
       return B::template offset<flecsi::topo::elements, A, DM>();
@@ -0,0 +1,46 @@
+// Redistributing an narray whose ragged field holds data is an error, since
+// ragged rows are not migrated.  This test passes if the error is reported.
+
+#include "narray.hh"
+
+#include "flecsi/util/unit.hh"
+
+using namespace flecsi;
+
+using mesh1d = mesh<1>;
+using ints = field<int, data::ragged>;
+
+const ints::definition<mesh1d> rows;
+
+void
+allocate(topo::resize::Field::accessor<wo> a) {
+  a = 100;
+}
+
+void
+fill(ints::mutator<wo, na> r) {
+  for(std::size_t i = 0; i < r.size(); ++i)
+    r[i].push_back(int(i));
+}
+
+int
+ragged_redistribute() {
+  UNIT() {
+    mesh1d::index_definition idef;
+    idef.axes = mesh1d::base::make_axes(processes(), {32});
+    idef.axes[0].hdepth = 1;
+
+    mesh1d::slot m;
+    m.allocate(mesh1d::mpi_coloring(idef));
+    execute<allocate>(rows(m).get_elements().sizes());
+    execute<fill>(rows(m));
+
+    std::vector<double> cost(m->colors(), 1);
+    cost[0] = 3;
+    m->rebalance(cost); // does not return
+    flog(error) << "ragged data was discarded" << std::endl;
+    ASSERT_TRUE(false);
+  };
+} // ragged_redistribute
+
+util::unit::driver<ragged_redistribute> driver;
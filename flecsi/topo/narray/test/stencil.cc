@@ -0,0 +1,85 @@
+// Check tiled against untiled traversal for 7- and 27-point stencils.
+
+#include "stencil.hh"
+
+#include "flecsi/util/unit.hh"
+
+using namespace flecsi;
+
+using ax = mesh3d::axis;
+
+const field<double>::definition<mesh3d> u, v, w;
+
+template<bool Star, bool Tiled>
+void
+sweep(mesh3d::accessor<ro> m,
+  field<double>::accessor<ro, ro> ua,
+  field<double>::accessor<wo, na> va,
+  exec::range_index t) {
+  const auto u = m.mdcolex<topo::elements>(ua);
+  const auto v = m.mdcolex<topo::elements>(va);
+  const auto x = logical<ax::x_axis>(m), y = logical<ax::y_axis>(m),
+             z = logical<ax::z_axis>(m);
+  if constexpr(Tiled) {
+    forall(p, (exec::mdtiles(u, {t, t, t}, x, y, z)), "tiled") {
+      v(p[0], p[1], p[2]) = stencil<Star>::apply(u, p);
+    };
+  }
+  else {
+    forall(p, (exec::mdiota_view(u, x, y, z)), "untiled") {
+      v(p[0], p[1], p[2]) = stencil<Star>::apply(u, p);
+    };
+  }
+}
+
+double
+difference(mesh3d::accessor<ro> m,
+  field<double>::accessor<ro, na> va,
+  field<double>::accessor<ro, na> wa) {
+  const auto a = m.mdcolex<topo::elements>(va);
+  const auto b = m.mdcolex<topo::elements>(wa);
+  const auto x = logical<ax::x_axis>(m), y = logical<ax::y_axis>(m),
+             z = logical<ax::z_axis>(m);
+  double ret = 0;
+  for(auto k = z.beg; k < z.end; ++k)
+    for(auto j = y.beg; j < y.end; ++j)
+      for(auto i = x.beg; i < x.end; ++i)
+        ret = std::max(ret, std::abs(a(i, j, k) - b(i, j, k)));
+  return ret;
+}
+
+template<bool Star>
+double
+compare(mesh3d::slot & m, exec::range_index t) {
+  execute<sweep<Star, false>, default_accelerator>(m, u(m), v(m), t);
+  execute<sweep<Star, true>, default_accelerator>(m, u(m), w(m), t);
+  return reduce<difference, exec::fold::max>(m, v(m), w(m)).get();
+}
+
+int
+stencil_driver() {
+  UNIT() {
+    const util::gid n = 12;
+    mesh3d::index_definition idef;
+    idef.axes = mesh3d::base::make_axes(processes(), {n, n, n});
+    for(auto & a : idef.axes) {
+      a.hdepth = 1;
+      a.bdepth = 1;
+      a.periodic = true;
+    }
+    idef.diagonals = true;
+    idef.full_ghosts = true;
+
+    mesh3d::slot m;
+    m.allocate(mesh3d::mpi_coloring(idef));
+    execute<init>(m, u(m));
+
+    // Tiles of 5 do not divide the colors, so partial tiles are visited.
+    for(const exec::range_index t : {1, 2, 5, 64}) {
+      EXPECT_EQ(compare<true>(m, t), 0.0);
+      EXPECT_EQ(compare<false>(m, t), 0.0);
+    }
+  };
+} // stencil_driver
+
+util::unit::driver<stencil_driver> driver;
@@ -0,0 +1,59 @@
+#ifndef FLECSI_TOPO_NARRAY_TEST_STENCIL_HH
+#define FLECSI_TOPO_NARRAY_TEST_STENCIL_HH
+
+#include "narray.hh"
+
+#include "flecsi/execution.hh"
+
+#include <array>
+#include <cmath>
+
+using mesh3d = mesh<3>;
+
+// The logical indices of a color along axis A.
+template<mesh3d::axis A>
+flecsi::exec::sub_range
+logical(mesh3d::accessor<flecsi::ro> m) {
+  const flecsi::exec::range_index o = m.template offset<A>();
+  return {o, flecsi::exec::range_index(o + m.template size<A>())};
+}
+
+// Set smooth values that differ along every axis.
+inline void
+init(mesh3d::accessor<flecsi::ro> m,
+  flecsi::field<double>::accessor<flecsi::wo, flecsi::na> ua) {
+  using ax = mesh3d::axis;
+  auto c = m.mdcolex<flecsi::topo::elements>(ua);
+  const auto x = logical<ax::x_axis>(m), y = logical<ax::y_axis>(m),
+             z = logical<ax::z_axis>(m);
+  for(auto k = z.beg; k < z.end; ++k)
+    for(auto j = y.beg; j < y.end; ++j)
+      for(auto i = x.beg; i < x.end; ++i)
+        c(i, j, k) = std::sin(0.1 * m.global_id<ax::x_axis>(i)) +
+                     std::cos(0.2 * m.global_id<ax::y_axis>(j)) +
+                     0.3 * m.global_id<ax::z_axis>(k);
+}
+
+// A 7-point (star) or 27-point (box) stencil.
+template<bool Star>
+struct stencil {
+  template<class U>
+  FLECSI_INLINE_TARGET static double
+  apply(const U & u, const std::array<flecsi::exec::range_index, 3> & p) {
+    const auto [i, j, k] = p;
+    if constexpr(Star)
+      return u(i, j, k) - (u(i - 1, j, k) + u(i + 1, j, k) + u(i, j - 1, k) +
+                            u(i, j + 1, k) + u(i, j, k - 1) + u(i, j, k + 1)) /
+                            6;
+    else {
+      double s = 0;
+      for(auto c = k - 1; c <= k + 1; ++c)
+        for(auto b = j - 1; b <= j + 1; ++b)
+          for(auto a = i - 1; a <= i + 1; ++a)
+            s += u(a, b, c);
+      return s / 27;
+    }
+  }
+};
+
+#endif
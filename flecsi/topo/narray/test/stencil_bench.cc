@@ -0,0 +1,100 @@
+// Compare the throughput of tiled and untiled traversal for 7- and 27-point
+// stencils on colors larger than a typical L2 cache.
+
+#include "stencil.hh"
+
+#include "flecsi/util/unit.hh"
+#include "flecsi/util/unit/bench.hh"
+
+#include <chrono>
+
+using namespace flecsi;
+
+using ax = mesh3d::axis;
+
+flecsi::program_option<int> size(util::unit::bench_options,
+  "size,n",
+  "Number of cells along each axis of each color.",
+  {{flecsi::option_default, 64}});
+flecsi::program_option<int> tile(util::unit::bench_options,
+  "tile,t",
+  "Number of cells along each axis of a tile.",
+  {{flecsi::option_default, 16}});
+
+const field<double>::definition<mesh3d> u, v;
+
+// Return the time spent sweeping, in seconds.
+template<bool Star, bool Tiled>
+double
+sweep(mesh3d::accessor<ro> m,
+  field<double>::accessor<ro, ro> ua,
+  field<double>::accessor<wo, na> va,
+  exec::range_index t) {
+  const auto u = m.mdcolex<topo::elements>(ua);
+  const auto v = m.mdcolex<topo::elements>(va);
+  const auto x = logical<ax::x_axis>(m), y = logical<ax::y_axis>(m),
+             z = logical<ax::z_axis>(m);
+  const auto start = std::chrono::steady_clock::now();
+  if constexpr(Tiled) {
+    forall(p, (exec::mdtiles(u, {t, t, t}, x, y, z)), "tiled") {
+      v(p[0], p[1], p[2]) = stencil<Star>::apply(u, p);
+    };
+  }
+  else {
+    forall(p, (exec::mdiota_view(u, x, y, z)), "untiled") {
+      v(p[0], p[1], p[2]) = stencil<Star>::apply(u, p);
+    };
+  }
+#if defined(FLECSI_ENABLE_KOKKOS)
+  Kokkos::fence();
+#endif
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+    .count();
+}
+
+// Return the best rate of the slowest color, in cells per second.
+template<bool Star, bool Tiled>
+double
+rate(mesh3d::slot & m, double cells) {
+  const exec::range_index t = tile.value();
+  return cells / util::unit::best([&] {
+    return reduce<sweep<Star, Tiled>, exec::fold::max, default_accelerator>(
+      m, u(m), v(m), t)
+      .get();
+  });
+}
+
+int
+stencil_bench() {
+  UNIT() {
+    const util::gid n = size.value();
+    const auto colors = mesh3d::base::distribute(processes(), {n, n, n});
+    mesh3d::index_definition idef;
+    idef.axes = mesh3d::base::make_axes(
+      colors, {colors[0] * n, colors[1] * n, colors[2] * n});
+    for(auto & a : idef.axes) {
+      a.hdepth = 1;
+      a.bdepth = 1;
+      a.periodic = true;
+    }
+    idef.diagonals = true;
+    idef.full_ghosts = true;
+
+    mesh3d::slot m;
+    m.allocate(mesh3d::mpi_coloring(idef));
+    execute<init>(m, u(m));
+
+    const double cells = double(n) * n * n;
+    for(const bool star : {true, false}) {
+      const double r0 = star ? rate<true, false>(m, cells)
+                             : rate<false, false>(m, cells),
+                   r1 = star ? rate<true, true>(m, cells)
+                             : rate<false, true>(m, cells);
+      flog(info) << (star ? 7 : 27) << "-point stencil on " << n << "^3 cells "
+                 << "per color: mdiota_view " << r0 << " cells/s, mdtiles ("
+                 << tile.value() << "^3) " << r1 << " cells/s" << std::endl;
+    }
+  };
+} // stencil_bench
+
+util::unit::driver<stencil_bench> driver;
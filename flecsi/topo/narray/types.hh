@@ -13,6 +13,9 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <map>
 #include <set>
 #include <vector>
@@ -469,6 +472,18 @@ struct index_definition {
     return indices;
   }
 
+  /// Number of ghost layers available on every side of a color that has
+  /// neighbors, counting the boundary layers of periodic axes.
+  util::id halo() const {
+    util::id ret = full_ghosts ? std::numeric_limits<util::id>::max() : 0;
+    for(const auto & ax : axes) {
+      ret = std::min(ret, ax.hdepth);
+      if(ax.periodic)
+        ret = std::min(ret, ax.bdepth);
+    }
+    return ret;
+  }
+
   /*!
    * Return a coloring for the current MPI rank on the given
    * communicator
@@ -490,27 +505,31 @@ struct index_definition {
      */
     std::vector<index_color> coloring;
     for(const Color c : cm[rank]) {
-      /*
-        Get the indices representation of our color.
-       */
-      narray_impl::colors color_indices;
-      {
-        Color i = c;
-        for(const auto & ax : axes) {
-          auto & axcm = ax.colormap;
-          color_indices.push_back(i % axcm.size());
-          i /= axcm.size();
-        }
-      }
-
       /*
         Make the coloring information for our color.
        */
-      coloring.emplace_back(make_color(color_indices));
+      coloring.emplace_back(make_color(color_indices(c)));
     } // for
     return coloring;
   }
 
+  /*!
+    Get the indices representation of a color.
+
+    @param c color
+
+    \return index of \a c along each axis
+   */
+  narray_impl::colors color_indices(Color c) const {
+    narray_impl::colors ret;
+    for(const auto & ax : axes) {
+      auto & axcm = ax.colormap;
+      ret.push_back(c % axcm.size());
+      c /= axcm.size();
+    }
+    return ret;
+  }
+
   /*!
     Create a coloring for the given color (as defined by color_indices).
 
@@ -524,34 +543,179 @@ struct index_definition {
     index_color idxco;
 
     for(Dimension axis = 0; axis < dimension; ++axis) {
-      auto & ax = axes[axis];
-      auto ci = color_indices[axis];
-      const util::offsets & em = ax.colormap;
-      const bool lo = (ci == 0);
-      const util::gid ex = ax.auxiliary;
+      idxco.axis_colors.push_back(make_color(axis, color_indices[axis]));
+    } // for
+
+    return idxco;
+  } // make_color
+
+  /*!
+    Create the coloring information for one axis of a color.
 
-      // primary coloring
-      util::gid offset_low = em(ci);
-      util::gid offset_high = em(ci + 1);
+    @param axis axis
+    @param ci index of the color along \a axis
+
+    \return coloring for the given axis
+   */
+  axis_color make_color(Dimension axis, util::id ci) const {
+    auto & ax = axes[axis];
+    const util::offsets & em = ax.colormap;
+    const bool lo = (ci == 0);
+    const util::gid ex = ax.auxiliary;
+
+    // primary coloring
+    util::gid offset_low = em(ci);
+    util::gid offset_high = em(ci + 1);
+
+    // modifications if auxiliary coloring
+    if(ex) {
+      offset_low += !lo;
+      offset_high += 1;
+    }
+
+    return {em.size(),
+      ci,
+      em.total() + ex,
+      ax.bdepth,
+      full_ghosts ? ax.hdepth : 0,
+      {offset_low, offset_high},
+      ax.periodic,
+      ax.auxiliary};
+  } // make_color
+
+  /*!
+    Create an index definition whose axes are divided so as to balance the
+    given cost per color.  The cost of each color is taken to be spread
+    uniformly over its logical entities; its projection onto each axis is then
+    divided into intervals of nearly equal cost.  Each color keeps at least
+    enough entities to supply its neighbors' ghosts.
 
-      // modifications if auxiliary coloring
-      if(ex) {
-        offset_low += !lo;
-        offset_high += 1;
+    @param cost measured cost of each color
+
+    \return copy of this definition with new colormaps
+   */
+  index_definition rebalanced(const std::vector<double> & cost) const {
+    flog_assert(cost.size() == colors(),
+      cost.size() << " costs for " << colors() << " colors");
+    index_definition ret = *this;
+
+    for(Dimension axis = 0; axis < dimensions(); ++axis) {
+      const auto & ax = axes[axis];
+      const util::offsets & em = ax.colormap;
+      const Color n = em.size();
+      const util::gid total = em.total();
+
+      // cost per entity of each color along this axis
+      std::vector<double> density(n);
+      for(Color c = 0; c < cost.size(); ++c) {
+        const auto ci = color_indices(c)[axis];
+        density[ci] += cost[c] / (em(ci + 1) - em(ci));
       }
 
-      idxco.axis_colors.push_back({em.size(),
-        ci,
-        em.total() + ex,
-        ax.bdepth,
-        full_ghosts ? ax.hdepth : 0,
-        {offset_low, offset_high},
-        ax.periodic,
-        ax.auxiliary});
+      // cumulative cost, indexed by entity boundaries
+      std::vector<double> sum(total + 1);
+      for(Color ci = 0; ci < n; ++ci)
+        for(util::gid g = em(ci); g < em(ci + 1); ++g)
+          sum[g + 1] = sum[g] + density[ci];
+      if(!(sum.back() > 0))
+        continue;
+
+      const util::gid least = std::max<util::gid>(
+        {1, ax.hdepth, ax.periodic ? ax.bdepth : util::id(0)});
+      flog_assert(total >= n * least,
+        "axis " << axis << " has too few entities to divide among " << n
+                << " colors");
+
+      util::offsets::storage end;
+      util::gid last = 0;
+      for(Color k = 1; k < n; ++k) {
+        const double target = sum.back() * k / n;
+        util::gid e =
+          std::lower_bound(sum.begin(), sum.end(), target) - sum.begin();
+        if(e && target - sum[e - 1] < sum[e] - target)
+          --e;
+        end.push_back(
+          last = std::clamp(e, last + least, total - (n - k) * least));
+      }
+      end.push_back(total);
+      ret.axes[axis].colormap = std::move(end);
     } // for
 
-    return idxco;
-  } // make_color
+    return ret;
+  } // rebalanced
+
+  /*!
+    Find the data for one color of this index definition in another with the
+    same number of colors along each axis (typically one from which it was
+    derived by \c rebalanced).  Every index point of the color, including
+    ghost and boundary points, is taken from the color that owns it (or, for
+    boundary points of a non-periodic axis, from the color at that end of the
+    axis).
+
+    @param from index definition that describes the current data
+    @param c color of this index definition
+    @param base offset to add to every local offset
+
+    \return pairs of local offset and remote offset for each color of \a from
+   */
+  index_color::points sources(const index_definition & from,
+    Color c,
+    std::size_t base = 0) const {
+    const Dimension dimension = dimensions();
+    const auto ci = color_indices(c);
+    flog_assert(from.dimensions() == dimension, "dimension mismatch");
+
+    // For each axis and local index, the color index and local index in from.
+    std::vector<std::vector<std::pair<util::id, util::id>>> src(dimension);
+    std::vector<std::vector<util::id>> fext(dimension);
+    coord ext(dimension);
+    for(Dimension axis = 0; axis < dimension; ++axis) {
+      const auto & fem = from.axes[axis].colormap;
+      flog_assert(fem.size() == axes[axis].colormap.size() &&
+                    fem.total() == axes[axis].colormap.total(),
+        "axis " << axis << " is not a redistribution");
+      for(Color i = 0; i < fem.size(); ++i)
+        fext[axis].push_back(from.make_color(axis, i).extent());
+
+      const auto ac = make_color(axis, ci[axis]);
+      const std::intmax_t n = ac.global();
+      ext[axis] = ac.extent();
+      for(util::id l = 0; l < ext[axis]; ++l) {
+        std::intmax_t g = ac.offset() + l;
+        g -= ac.logical<0>();
+        util::id o;
+        if((g < 0 || g >= n) && !ac.periodic)
+          o = g < 0 ? 0 : fem.size() - 1;
+        else {
+          g = (g % n + n) % n;
+          o = ac.auxiliary ? (g ? fem.bin(g - 1) : 0) : fem.bin(g);
+        }
+        const auto fc = from.make_color(axis, o);
+        src[axis].push_back(
+          {o, util::id(fc.logical<0>() + g - std::intmax_t(fc.offset()))});
+      }
+    } // for
+
+    index_color::points ret;
+    coord idx(dimension);
+    for(std::size_t i = 0;; ++i) {
+      Color co = 0;
+      std::size_t off = 0;
+      for(Dimension axis = dimension; axis--;) {
+        const auto & [o, l] = src[axis][idx[axis]];
+        co = co * fext[axis].size() + o;
+        off = off * fext[axis][o] + l;
+      }
+      ret[co].emplace_back(base + i, off);
+
+      Dimension axis = 0;
+      for(; axis < dimension && ++idx[axis] == ext[axis]; ++axis)
+        idx[axis] = 0;
+      if(axis == dimension)
+        break;
+    }
+    return ret;
+  } // sources
 
   /*!
     Compute the ghost points and intervals for a given process coloring
@@ -1055,6 +1219,36 @@ struct narray_base {
     }
   }
 
+  // for redistribute: move the appended layout of each color to the front
+  template<PrivilegeCount N>
+  static void shift(
+    field<std::byte, data::raw>::accessor1<privilege_repeat<rw, N>> a,
+    std::vector<std::size_t> const & from,
+    std::vector<std::size_t> const & to,
+    std::size_t size) {
+    std::byte * const p = a.span().data();
+    const auto c = flecsi::color();
+    std::memmove(p, p + from[c] * size, to[c] * size);
+  }
+
+  // for redistribute: return the largest ragged offset, which is 0 if every
+  // row is empty
+  template<PrivilegeCount N>
+  static std::size_t occupied(
+    field<std::size_t, data::raw>::accessor1<privilege_ghost_repeat<ro, na, N>>
+      off) {
+    const auto s = off.span();
+    return s.empty() ? 0 : *std::max_element(s.begin(), s.end());
+  }
+
+  // for redistribute: leave every row of a ragged field empty
+  template<PrivilegeCount N>
+  static void clear(
+    field<std::size_t, data::raw>::accessor1<privilege_repeat<wo, N>> off) {
+    const auto s = off.span();
+    std::fill(s.begin(), s.end(), 0);
+  }
+
 }; // struct narray_base
 
 /// \}
@@ -31,7 +31,9 @@ struct Particle {
 using accessorm = unstructured::accessor<ro, ro, ro>;
 
 using particle_field = field<Particle, data::particle>;
-const particle_field::definition<spec_setopo_t> particles;
+const particle_field::definition<spec_setopo_t> particles, moved;
+using origin_field = field<Color, data::particle>;
+const origin_field::definition<spec_setopo_t> origin;
 
 void
 init_fields(accessorm m,
@@ -85,6 +87,49 @@ update_test(particle_field::accessor<rw> particle_t) {
   flog(info) << ss.rdbuf() << std::endl;
 }
 
+void
+init_moved(accessorm m,
+  field<util::gid>::accessor<ro, ro, ro> cids,
+  particle_field::mutator<wo> p,
+  origin_field::mutator<wo> o) {
+  for(auto c : m.cells()) {
+    p.insert({1.0, cids[c]});
+    o.insert(color());
+  }
+}
+
+// Every third particle goes to color 0, which must grow to hold them.
+Color
+destination(const Particle & p) {
+  return p.cgid % 3 ? color() : 0;
+}
+
+std::size_t
+count_moved(particle_field::accessor<ro> p) {
+  return p.size();
+}
+
+int
+check_moved(particle_field::accessor<ro> p, origin_field::accessor<ro> o) {
+  UNIT("TASK") {
+    EXPECT_EQ(p.size(), o.size());
+    auto j = o.begin();
+    for(auto i = p.begin(); i != p.end(); ++i, ++j) {
+      ASSERT_EQ(i.location(), j.location());
+      EXPECT_EQ(destination(*i), color());
+      if(*j != color()) {
+        EXPECT_EQ(i->cgid % 3, 0u);
+      }
+    }
+    if(color()) {
+      EXPECT_LE(p.capacity(), 100u);
+    }
+    else if(processes() > 1) {
+      EXPECT_GT(p.capacity(), 100u);
+    }
+  };
+}
+
 int
 set_driver() {
 
@@ -105,6 +150,17 @@ set_driver() {
     execute<insert_test, default_accelerator>(
       mesh_underlying, unstructured::cid(mesh_underlying), particle_t);
     execute<update_test>(particle_t);
+
+    const auto mp = moved(spec_setopo);
+    const auto mo = origin(spec_setopo);
+    mp.topology().get_partition<decltype(mp)::space>().growth = {
+      0, 0, 0.25, 0.5, 1};
+    execute<init_moved>(
+      mesh_underlying, unstructured::cid(mesh_underlying), mp, mo);
+    const std::size_t n = reduce<count_moved, exec::fold::sum>(mp).get();
+    data::migrate_particles(destination, mp, mo);
+    EXPECT_EQ(test<check_moved>(mp, mo), 0);
+    EXPECT_EQ((reduce<count_moved, exec::fold::sum>(mp).get()), n);
   };
 
 } // set_driver
@@ -0,0 +1,119 @@
+// Compare ragged transfers through single-page and growable buffers.
+
+#include "flecsi/util/unit.hh"
+#include "flecsi/util/unit/bench.hh"
+#include <flecsi/data.hh>
+#include <flecsi/execution.hh>
+
+using namespace flecsi;
+using namespace flecsi::data;
+
+flecsi::program_option<int> count(util::unit::bench_options,
+  "count,n",
+  "Number of rows on each color.",
+  {{flecsi::option_default, 100}});
+flecsi::program_option<int> length(util::unit::bench_options,
+  "length,l",
+  "Number of elements in each row.",
+  {{flecsi::option_default, 250}});
+
+struct array : topo::specialization<topo::user, array> {};
+
+using row_field = field<double, ragged>;
+const row_field::definition<array> source, ghost;
+
+double
+value(Color c, std::size_t i, std::size_t j) {
+  return c * 1e6 + i * 1e3 + j;
+}
+
+void
+allocate(topo::resize::Field::accessor<wo> a) {
+  a = count.value() * length.value();
+}
+
+void
+fill(row_field::mutator<wo> m) {
+  const auto c = color();
+  for(std::size_t i = 0; i < m.size(); ++i) {
+    const auto r = m[i];
+    r.reserve(length.value());
+    for(int j = 0; j < length.value(); ++j)
+      r.push_back(value(c, i, j));
+  }
+}
+
+// Send all rows to the next color.
+bool
+send(row_field::accessor<ro> v, buffers::Buffer & b, bool first) {
+  bool sent = false;
+  buffers::ragged w(b, first);
+  for(std::size_t i = 0; i < v.size(); ++i)
+    if(!w(v, i, sent))
+      break;
+  return sent;
+}
+
+void
+start(row_field::accessor<ro> v, row_field::mutator<wo>, buffers::Start mv) {
+  send(v, mv[0], true);
+}
+
+int
+xfer(row_field::accessor<ro> v,
+  row_field::mutator<rw> g,
+  buffers::Transfer mv) {
+  buffers::ragged::read(g, mv[1], util::iota_view<std::size_t>(0, g.size()));
+  return send(v, mv[0], false);
+}
+
+int
+check(row_field::accessor<ro> g) {
+  UNIT("TASK") {
+    const auto p = processes(), c = (color() + p - 1) % p;
+    for(std::size_t i = 0; i < g.size(); ++i) {
+      const auto r = g[i];
+      ASSERT_EQ(r.size(), std::size_t(length.value()));
+      for(std::size_t j = 0; j < r.size(); ++j)
+        ASSERT_EQ(r[j], value(c, i, j));
+    }
+  };
+}
+
+int
+buffers_bench() {
+  UNIT() {
+    array::slot a;
+    a.allocate(array::coloring(processes(), count.value()));
+    const auto r = source(a), g = ghost(a);
+    for(auto & f : {r, g}) {
+      auto & p = f.get_elements();
+      execute<allocate>(p.sizes());
+      p.resize();
+    }
+    execute<fill>(r);
+
+    const auto graph = [] {
+      const auto p = processes();
+      buffers::coloring ret(p);
+      Color i = 0;
+      for(auto & d : ret)
+        d.push_back(++i % p);
+      return ret;
+    }();
+    const auto run = [&](std::size_t pages) {
+      buffers::core b(graph, pages);
+      const auto once = [&] { b.xfer<::start, ::xfer>(r, g); };
+      once(); // the first transfer sizes the buffers
+      const double t = util::unit::best(once);
+      EXPECT_EQ(test<check>(g), 0);
+      flog(info) << "up to " << pages << " pages: " << b.pages()
+                 << " pages per edge, best " << t << " s" << std::endl;
+      return b.pages();
+    };
+    EXPECT_EQ(run(1), 1u);
+    EXPECT_GT(run(buffers::ragged::pages), 1u);
+  };
+} // buffers_bench
+
+util::unit::driver<buffers_bench> driver;
@@ -30,7 +30,10 @@ struct trivial_array : topo::specialization<topo::user, trivial_array> {};
 
 using short_part = field<short, particle>;
 const short_part::definition<trivial_array> particles;
-const intN::definition<trivial_array> arag;
+const intN::definition<trivial_array> arag, grag;
+// Rows long enough that those of each color span several buffer pages.
+const intN::definition<trivial_array> long_rows, long_ghost;
+constexpr std::size_t long_count = 4, long_length = 600;
 
 constexpr std::size_t column = 42;
 
@@ -77,6 +80,24 @@ drows(double_at::mutator<wo> s) {
     EXPECT_EQ((*m.find(column)).second, me);
     EXPECT_EQ(m.lower_bound(column), m.begin());
     EXPECT_EQ(m.upper_bound((*--m.end()).first), m.end());
+
+    const auto && d = s[0];
+    const auto n = d.size();
+    for(const int k : {5, 1, 4, 2, 3})
+      EXPECT_TRUE(d.try_emplace(k, k).second);
+    EXPECT_FALSE(d.try_emplace(4, 0).second);
+    EXPECT_EQ(d.count(3), 1u);
+    EXPECT_EQ(d.erase(2), 1u);
+    d.insert({{2, 2}, {6, 6}, {3, 0}, {6, 0}});
+    ASSERT_EQ(d.size(), n + 6);
+    std::size_t k = 0;
+    for(const auto && p : d)
+      if(++k <= 6) {
+        EXPECT_EQ(p.first, k);
+        EXPECT_EQ(p.second, k);
+      }
+    d.erase(d.begin(), d.find(column));
+    EXPECT_EQ(d.size(), n);
   };
 }
 
@@ -121,6 +142,53 @@ ragged_xfer(intN::accessor<ro> v, intN::mutator<rw> g, buffers::Transfer mv) {
   return sent;
 }
 
+void
+reserve_long(topo::resize::Field::accessor<wo> a) {
+  a = long_count * long_length;
+}
+int
+long_value(Color c, std::size_t i, std::size_t j, int base) {
+  return base + c * 10000 + i * 1000 + j;
+}
+void
+fill_long(intN::mutator<wo> m, int base) {
+  const auto c = color();
+  for(std::size_t i = 0; i < m.size(); ++i)
+    for(std::size_t j = 0; j < long_length; ++j)
+      m[i].push_back(long_value(c, i, j, base));
+}
+bool
+send_long(intN::accessor<ro> v, buffers::Buffer & b, bool first) {
+  bool sent = false;
+  buffers::ragged w(b, first);
+  for(std::size_t i = 0; i < v.size(); ++i)
+    if(!w(v, i, sent))
+      break;
+  return sent;
+}
+void
+long_start(intN::accessor<ro> v, intN::mutator<wo>, buffers::Start mv) {
+  send_long(v, mv[0], true);
+}
+int
+long_xfer(intN::accessor<ro> v, intN::mutator<rw> g, buffers::Transfer mv) {
+  buffers::ragged::read(g, mv[1], util::iota_view<std::size_t>(0, g.size()));
+  return send_long(v, mv[0], false);
+}
+int
+check_long(intN::accessor<ro> g, int base) {
+  UNIT("TASK") {
+    const auto p = processes(), c = (color() + p - 1) % p;
+    ASSERT_EQ(g.size(), long_count);
+    for(std::size_t i = 0; i < g.size(); ++i) {
+      const auto r = g[i];
+      ASSERT_EQ(r.size(), long_length);
+      for(std::size_t j = 0; j < r.size(); ++j)
+        ASSERT_EQ(r[j], long_value(c, i, j, base));
+    }
+  };
+}
+
 int
 check(double_field::accessor<ro> p,
   intN::accessor<ro> r,
@@ -190,6 +258,51 @@ part(short_part::mutator<wo> a) {
   };
 }
 
+// Leave particles 0, 2, and 3 with a hole at slot 1.
+int
+churn(short_part::mutator<wo> m) {
+  UNIT("TASK") {
+    for(short i = 0; i < 4; ++i)
+      m.insert(i);
+    ASSERT_EQ(m.size(), m.capacity());
+    m.erase(++m.begin());
+    EXPECT_EQ(m.size(), 3u);
+  };
+}
+
+int
+compact(short_part::mutator<rw> m) {
+  UNIT("TASK") {
+    const auto perm = m.compact();
+    ASSERT_EQ(perm.size(), 3u);
+    EXPECT_EQ(perm[0], 0u);
+    EXPECT_EQ(perm[1], 2u);
+    EXPECT_EQ(perm[2], 3u);
+    const short want[] = {0, 2, 3};
+    std::size_t j = 0;
+    for(auto i = m.begin(); i != m.end(); ++i, ++j) {
+      EXPECT_EQ(i.location(), j);
+      EXPECT_EQ(*i, want[j]);
+    }
+    EXPECT_EQ(j, 3u);
+  };
+}
+
+int
+grown(short_part::mutator<rw> m) {
+  UNIT("TASK") {
+    ASSERT_EQ(m.capacity(), 7u);
+    ASSERT_EQ(m.size(), 3u);
+    const short want[] = {0, 2, 3};
+    std::size_t j = 0;
+    for(auto x : m)
+      EXPECT_EQ(x, want[j++]);
+    for(short i = 4; i < 8; ++i)
+      EXPECT_EQ(m.insert(i).location(), i - 1u);
+    EXPECT_EQ(m.size(), m.capacity());
+  };
+}
+
 // The MPI backend doesn't support non-trivial color mappings:
 constexpr int process_fraction = 2 - (FLECSI_BACKEND == FLECSI_BACKEND_mpi);
 
@@ -211,6 +324,29 @@ use_map(data::multi<short_part::accessor<ro>> ma,
   };
 }
 
+void
+reserve(topo::resize::Field::accessor<wo> a) {
+  a = 100;
+}
+// Row i gains i%3+v-1 copies of v.
+void
+grow(intN::mutator<rw> m, int v) {
+  for(std::size_t i = 0; i < m.size(); ++i)
+    for(auto n = i % 3 + v - 1; n--;)
+      m[i].push_back(v);
+}
+int
+check_grow(intN::accessor<ro> a) {
+  UNIT("TASK") {
+    for(std::size_t i = 0; i < a.size(); ++i) {
+      const auto r = a[i];
+      ASSERT_EQ(r.size(), 2 * (i % 3) + 1);
+      for(std::size_t j = 0; j < r.size(); ++j)
+        EXPECT_EQ(r[j], j < i % 3 ? 1 : 2);
+    }
+  };
+}
+
 int
 check_map(intN::accessor<ro> a) {
   UNIT() {
@@ -259,18 +395,40 @@ index_driver() {
     execute<use_ptr, flecsi::mpi>(ptr_field(process_topology));
 
     // Rotate the ragged field by one color:
-    buffers::core([] {
+    const auto rotate = [] {
       const auto p = processes();
       buffers::coloring ret(p);
       Color i = 0;
       for(auto & g : ret)
         g.push_back(++i % p);
       return ret;
-    }())
-      .xfer<ragged_start, ragged_xfer>(verts, ghost);
+    }();
+    buffers::core(rotate).xfer<ragged_start, ragged_xfer>(verts, ghost);
 
     EXPECT_EQ(test<check>(pressure, verts, ghost, vfrac, noise), 0);
 
+    {
+      trivial_array::slot l;
+      l.allocate(trivial_array::coloring(processes(), long_count));
+      for(auto & p : {long_rows(l), long_ghost(l)}) {
+        auto & e = p.get_elements();
+        execute<reserve_long>(e.sizes());
+        e.resize();
+      }
+      buffers::core b(rotate, buffers::ragged::pages);
+      // The first transfer takes several rounds of one page each:
+      execute<fill_long>(long_rows(l), 0);
+      b.xfer<long_start, long_xfer>(long_rows(l), long_ghost(l));
+      EXPECT_EQ(test<check_long>(long_ghost(l), 0), 0);
+      const auto k = b.pages();
+      EXPECT_GT(k, 1u);
+      // ...after which each edge has enough pages for one round.
+      execute<fill_long>(long_rows(l), 1);
+      b.xfer<long_start, long_xfer>(long_rows(l), long_ghost(l));
+      EXPECT_EQ(test<check_long>(long_ghost(l), 1), 0);
+      EXPECT_EQ(b.pages(), k);
+    }
+
     // Duplicate work to support the MPI backend:
     trivial_array::slot a;
     a.allocate(trivial_array::coloring(processes(), 12));
@@ -280,11 +438,28 @@ index_driver() {
       execute<allocate>(p.sizes());
       p.resize();
     }
+    {
+      auto & p = grag(a).get_elements();
+      execute<reserve>(p.sizes());
+      p.resize();
+      execute<grow>(grag(a), 1);
+      execute<grow>(grag(a), 2);
+      EXPECT_EQ(test<check_grow>(grag(a)), 0);
+    }
 
     auto lm = launch::make(
       a, launch::robin(a.colors(), std::max(np / process_fraction, {1})));
     EXPECT_EQ(test<use_map>(particles(lm), arag(lm)), 0);
     EXPECT_EQ(test<check_map>(arag(a)), 0);
+
+    trivial_array::slot b;
+    b.allocate(trivial_array::coloring(processes(), 4));
+    const auto pb = particles(b);
+    EXPECT_EQ(test<churn>(pb), 0);
+    EXPECT_EQ(test<compact>(pb), 0);
+    pb.topology().get_partition<decltype(pb)::space>().growth = {0, 4};
+    data::resize_particles(pb);
+    EXPECT_EQ(test<grown>(pb), 0);
   };
 } // index
 
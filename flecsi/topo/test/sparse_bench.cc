@@ -0,0 +1,111 @@
+// Compare separate and bulk insertion of keys in random order into sparse
+// rows.
+
+#include "flecsi/util/unit.hh"
+#include "flecsi/util/unit/bench.hh"
+#include <flecsi/data.hh>
+#include <flecsi/execution.hh>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace flecsi;
+using namespace flecsi::data;
+
+flecsi::program_option<int> count(util::unit::bench_options,
+  "count,n",
+  "Number of rows.",
+  {{flecsi::option_default, 200}});
+
+struct array : topo::specialization<topo::user, array> {};
+
+using sparse_field = field<double, sparse>;
+const sparse_field::definition<array> sorted, bulk;
+
+constexpr std::size_t min_keys = 50, max_keys = 200, keys = 1000;
+
+// The keys inserted into row i, with repetitions.
+std::vector<std::pair<std::size_t, double>>
+row_keys(std::size_t i) {
+  std::mt19937 gen(i);
+  std::uniform_int_distribution<std::size_t> key(0, keys - 1);
+  std::vector<std::pair<std::size_t, double>> ret(
+    min_keys + i % (max_keys - min_keys + 1));
+  for(auto & [k, v] : ret) {
+    k = key(gen);
+    v = k + i / 2.0;
+  }
+  return ret;
+}
+
+void
+allocate(topo::resize::Field::accessor<wo> a) {
+  a = count.value() * max_keys;
+}
+
+// Return the time spent inserting, in seconds.
+double
+fill(sparse_field::mutator<wo> m, bool all) {
+  const auto n = m.size();
+  std::vector<std::vector<std::pair<std::size_t, double>>> in(n);
+  for(std::size_t i = 0; i < n; ++i)
+    in[i] = row_keys(i);
+  const auto start = std::chrono::steady_clock::now();
+  for(std::size_t i = 0; i < n; ++i) {
+    const auto r = m[i];
+    if(all)
+      r.insert(in[i].begin(), in[i].end());
+    else
+      for(auto & [k, v] : in[i])
+        r.try_emplace(k, v);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+    .count();
+}
+
+int
+check(sparse_field::accessor<ro> s, sparse_field::accessor<ro> b) {
+  UNIT("TASK") {
+    for(std::size_t i = 0; i < s.size(); ++i) {
+      std::map<std::size_t, double> ref;
+      for(auto & p : row_keys(i))
+        ref.insert(p);
+      const auto same = [&](const auto & a) {
+        const auto r = a.get_base()[i]; // the ragged interface iterates
+        return r.size() == ref.size() &&
+               std::equal(
+                 r.begin(), r.end(), ref.begin(), [](auto & x, auto & y) {
+                   return x.first == y.first && x.second == y.second;
+                 });
+      };
+      ASSERT_TRUE(same(s));
+      ASSERT_TRUE(same(b));
+    }
+  };
+}
+
+int
+sparse_bench() {
+  UNIT() {
+    array::slot a;
+    a.allocate(array::coloring(processes(), count.value()));
+    for(auto * f : {&sorted, &bulk}) {
+      auto & p = (*f)(a).get_elements();
+      execute<allocate>(p.sizes());
+      p.resize();
+    }
+
+    const auto best = [&](auto & f, bool all) {
+      return util::unit::best([&] { return execute<fill>(f(a), all).get(); });
+    };
+    const double t0 = best(sorted, false), t1 = best(bulk, true);
+    EXPECT_EQ(test<check>(sorted(a), bulk(a)), 0);
+    flog(info) << count.value() << " rows of " << min_keys << "-" << max_keys
+               << " keys: sorted " << t0 << " s, bulk " << t1 << " s"
+               << std::endl;
+  };
+} // sparse_bench
+
+util::unit::driver<sparse_bench> driver;
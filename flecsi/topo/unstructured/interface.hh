@@ -143,7 +143,8 @@ private:
         make_copy_plan<VV>(c)...
         }
       },
-      buffers_ {{data::buffers::core(c.idx_spaces[index<VV>].peers)...}}
+      buffers_ {{data::buffers::core(c.idx_spaces[index<VV>].peers,
+        data::buffers::ragged::pages)...}}
 
   {
     allocate_connectivities(c, connect_);
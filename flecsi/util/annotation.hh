@@ -5,6 +5,7 @@
 #define FLECSI_UTIL_ANNOTATION_HH
 
 #include "flecsi/config.hh"
+#include "flecsi/util/profile.hh"
 
 #if FLECSI_CALIPER_DETAIL != FLECSI_CALIPER_DETAIL_none
 #include <caliper/Annotation.h>
@@ -277,7 +278,8 @@ public:
  * Scope guard for marking a code region.
  *
  * This type is used to mark a code region identified with a region
- * type based on the lifetime of the guard.
+ * type based on the lifetime of the guard.  The region is also timed by
+ * the \ref profile "built-in profiler" if it is enabled.
  *
  * \tparam reg code region to tag (type inherits from annotation::region)
  */
@@ -288,12 +290,19 @@ public:
   /// Create a guard.
   /// \param a an optional task name as a \c std::string_view
   template<class... Arg>
-  rguard(Arg &&... a) {
+  rguard(Arg &&... a) : profiled(profile::enabled()) {
+    if(profiled)
+      profile::begin(reg::name, std::string_view(a)...);
     region_begin<reg>(std::forward<Arg>(a)...);
   }
   ~rguard() {
     region_end<reg>();
+    if(profiled)
+      profile::end();
   }
+
+private:
+  bool profiled;
 };
 /// \}
 } // namespace annotation
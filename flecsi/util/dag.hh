@@ -6,6 +6,7 @@
 
 #include "flecsi/config.hh"
 #include "flecsi/flog.hh"
+#include "flecsi/util/demangle.hh"
 
 #if defined(FLECSI_ENABLE_GRAPHVIZ)
 #include "flecsi/util/graphviz.hh"
@@ -15,7 +16,6 @@
 #include <iostream>
 #include <list>
 #include <map>
-#include <queue>
 #include <regex>
 #include <sstream>
 #include <vector>
@@ -86,63 +86,59 @@ struct dag : std::vector<dag_impl::node<NodePolicy> *> {
   }
 
   /*!
-    Topological sort using Kahn's algorithm.
+    Topological sort using Kahn's algorithm.  The nodes are grouped into
+    levels: every node in a level depends only on nodes in earlier levels,
+    so the nodes within one level may be executed in any order (or
+    concurrently).  The DAG itself is not modified.
 
-    @return A valid sequence of the nodes in the DAG.
+    @return the levels of the DAG, in order
    */
 
-  sorted_type sort() const {
-    sorted_type sorted;
+  std::vector<sorted_type> levels() const {
+    std::vector<sorted_type> ret;
 
-    // Create a temporary list of the nodes.
-    std::list<node_type *> nodes;
+    // Tally the number of unsatisfied dependencies of each node and record
+    // the reverse edges.
+    std::map<const node_type *, std::size_t> tally;
+    std::map<const node_type *, sorted_type> downstream;
+    sorted_type ready;
     for(auto n : *this) {
-      nodes.push_back(n);
-    } // for
-
-    // Create a tally of the number of dependencies of each node
-    // in the graph. Remove nodes from the temporary list that do not
-    // have any depenendencies.
-    std::queue<node_type *> q;
-    for(auto n = nodes.begin(); n != nodes.end();) {
-      if((*n)->size() == 0) {
-        q.push(*n);
-        n = nodes.erase(n);
-      }
-      else {
-        ++n;
-      } // if
+      tally[n] = n->size();
+      for(auto e : *n)
+        downstream[e].push_back(n);
+      if(n->empty())
+        ready.push_back(n);
     } // for
 
-    size_t count{0};
-    while(!q.empty()) {
-      const auto root = q.front();
-      sorted.push_back(root);
-      q.pop();
-
-      for(auto n = nodes.begin(); n != nodes.end();) {
-        auto it = std::find_if((*n)->begin(),
-          (*n)->end(),
-          [&root](const auto p) { return root == p; });
-
-        if(it != (*n)->end()) {
-          (*n)->erase(it);
-
-          if(!(*n)->size()) {
-            q.push(*n);
-            n = nodes.erase(n);
-          } // if
-        }
-        else {
-          ++n;
-        } // if
+    std::size_t count{0};
+    while(!ready.empty()) {
+      sorted_type next;
+      for(auto root : ready) {
+        if(const auto d = downstream.find(root); d != downstream.end())
+          for(auto n : d->second)
+            if(!--tally[n])
+              next.push_back(n);
       } // for
-
-      ++count;
+      count += ready.size();
+      ret.push_back(std::move(ready));
+      ready = std::move(next);
     } // while
 
     flog_assert(count == this->size(), "sorting failed. This is not a DAG!!!");
 
+    return ret;
+  } // levels
+
+  /*!
+    Topological sort; the concatenation of \c levels.
+
+    @return A valid sequence of the nodes in the DAG.
+   */
+
+  sorted_type sort() const {
+    sorted_type sorted;
+    for(auto & l : levels())
+      sorted.insert(sorted.end(), l.begin(), l.end());
     return sorted;
   } // sort
 
@@ -4,10 +4,123 @@
 #ifndef FLECSI_UTIL_GEOMETRY_FILLING_CURVE_HH
 #define FLECSI_UTIL_GEOMETRY_FILLING_CURVE_HH
 
+#include "flecsi/util/array_ref.hh"
 #include "flecsi/util/geometry/point.hh"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 namespace flecsi {
 
+namespace detail {
+// Bit interleaving for keys of D dimensions: spread moves bit i of its
+// argument to bit D*i, and compact gathers those bits back.  With BMI2 (e.g.,
+// -mbmi2 or -march=native), these are single PDEP/PEXT instructions;
+// otherwise, a few shifts and masks ("magic bits") are used.
+template<Dimension D, typename T>
+struct interleave {
+  static constexpr std::size_t bits = sizeof(T) * 8;
+  static constexpr T mask = [] {
+    T ret = 0;
+    for(std::size_t i = 0; i < bits; i += D)
+      ret |= T(1) << i;
+    return ret;
+  }();
+
+  static T spread(T x) {
+    if constexpr(D == 1)
+      return x;
+    else {
+#if defined(__BMI2__)
+      if constexpr(bits <= 32)
+        return T(_pdep_u32(std::uint32_t(x), std::uint32_t(mask)));
+      else if constexpr(bits == 64)
+        return T(_pdep_u64(std::uint64_t(x), std::uint64_t(mask)));
+      else
+#endif
+        return magic_spread(x);
+    }
+  }
+
+  static T compact(T x) {
+    if constexpr(D == 1)
+      return x;
+    else {
+#if defined(__BMI2__)
+      if constexpr(bits <= 32)
+        return T(_pext_u32(std::uint32_t(x), std::uint32_t(mask)));
+      else if constexpr(bits == 64)
+        return T(_pext_u64(std::uint64_t(x), std::uint64_t(mask)));
+      else
+#endif
+        return magic_compact(x);
+    }
+  }
+
+private:
+  static T magic_spread(T x) {
+    if constexpr(bits <= 64 && D == 2) {
+      std::uint64_t v = std::uint64_t(x) & 0x00000000FFFFFFFF;
+      v = (v | v << 16) & 0x0000FFFF0000FFFF;
+      v = (v | v << 8) & 0x00FF00FF00FF00FF;
+      v = (v | v << 4) & 0x0F0F0F0F0F0F0F0F;
+      v = (v | v << 2) & 0x3333333333333333;
+      v = (v | v << 1) & 0x5555555555555555;
+      return T(v);
+    }
+    else if constexpr(bits <= 64 && D == 3) {
+      std::uint64_t v = std::uint64_t(x) & 0x1FFFFF;
+      v = (v | v << 32) & 0x1F00000000FFFF;
+      v = (v | v << 16) & 0x1F0000FF0000FF;
+      v = (v | v << 8) & 0x100F00F00F00F00F;
+      v = (v | v << 4) & 0x10C30C30C30C30C3;
+      v = (v | v << 2) & 0x1249249249249249;
+      return T(v);
+    }
+    else {
+      T ret = 0;
+      for(std::size_t i = 0; i * D < bits; ++i)
+        ret |= (x >> i & T(1)) << i * D;
+      return ret;
+    }
+  }
+
+  static T magic_compact(T x) {
+    if constexpr(bits <= 64 && D == 2) {
+      std::uint64_t v = std::uint64_t(x) & 0x5555555555555555;
+      v = (v | v >> 1) & 0x3333333333333333;
+      v = (v | v >> 2) & 0x0F0F0F0F0F0F0F0F;
+      v = (v | v >> 4) & 0x00FF00FF00FF00FF;
+      v = (v | v >> 8) & 0x0000FFFF0000FFFF;
+      v = (v | v >> 16) & 0x00000000FFFFFFFF;
+      return T(v);
+    }
+    else if constexpr(bits <= 64 && D == 3) {
+      std::uint64_t v = std::uint64_t(x) & 0x1249249249249249;
+      v = (v | v >> 2) & 0x10C30C30C30C30C3;
+      v = (v | v >> 4) & 0x100F00F00F00F00F;
+      v = (v | v >> 8) & 0x1F0000FF0000FF;
+      v = (v | v >> 16) & 0x1F00000000FFFF;
+      v = (v | v >> 32) & 0x1FFFFF;
+      return T(v);
+    }
+    else {
+      T ret = 0;
+      for(std::size_t i = 0; i * D < bits; ++i)
+        ret |= (x >> i * D & T(1)) << i;
+      return ret;
+    }
+  }
+};
+} // namespace detail
+
 // Space filling curve
 template<Dimension DIM, typename T, class DERIVED>
 class filling_curve
@@ -19,6 +132,9 @@ class filling_curve
   // Geometric point to represent coordinates
   // \todo Template double type
   using point_t = util::point<double, dimension>;
+  // Integer coordinates at max_depth_
+  using coord_t = std::array<int_t, dimension>;
+  using bits_t = detail::interleave<DIM, T>;
 
 protected:
   static constexpr std::size_t bits_ =
@@ -29,9 +145,76 @@ protected:
 
   int_t value_;
 
+  // Convert one coordinate of a position in [min, min+scale] to an integer.
+  static int_t quantize(double x, double min, double scale) {
+    constexpr int_t max_val = (int_t(1) << max_depth_) - 1;
+    return std::min(max_val,
+      static_cast<int_t>(
+        (x - min) / scale * static_cast<double>(int_t(1) << max_depth_)));
+  }
+  static coord_t quantize(const std::array<point_t, 2> & range,
+    const point_t & p) {
+    coord_t ret;
+    for(Dimension i = 0; i < dimension; ++i)
+      ret[i] = quantize(p[i], range[0][i], range[1][i] - range[0][i]);
+    return ret;
+  }
+
+  // Interleave integer coordinates so that bit i of coordinate j is bit
+  // i*dimension+j of the result.
+  static int_t interleave(const coord_t & c) {
+    int_t ret = 0;
+    for(Dimension j = 0; j < dimension; ++j)
+      ret |= bits_t::spread(c[j]) << j;
+    return ret;
+  }
+  static coord_t deinterleave(int_t m) {
+    coord_t ret;
+    for(Dimension j = 0; j < dimension; ++j)
+      ret[j] = bits_t::compact(m >> j);
+    return ret;
+  }
+
+  // Convert integer coordinates back to a position.
+  static void unquantize(const std::array<point_t, 2> & range,
+    const coord_t & c,
+    point_t & p) {
+    for(Dimension j = 0; j < dimension; ++j) {
+      double min = range[0][j];
+      double scale = range[1][j] - min;
+      p[j] = min + scale * static_cast<double>(c[j]) / (int_t(1) << max_depth_);
+    } // for
+  }
+
 public:
   constexpr filling_curve() : value_(0) {}
 
+  // Compute the keys (at max depth) of many points at once; the same as
+  // constructing each key from \p range and a point.
+  static void encode(const std::array<point_t, 2> & range,
+    util::span<const point_t> p,
+    util::span<DERIVED> k) {
+    assert(p.size() == k.size());
+    for(std::size_t i = 0; i < p.size(); ++i) {
+      int_t m = 0;
+      for(Dimension j = 0; j < dimension; ++j)
+        m |= bits_t::spread(
+               quantize(p[i][j], range[0][j], range[1][j] - range[0][j]))
+             << j;
+      k[i] = DERIVED(DERIVED::key(m, max_depth_));
+    }
+  }
+
+  // Compute the positions of many keys (at max depth) at once; the same as
+  // calling \c coordinates on each.
+  static void decode(const std::array<point_t, 2> & range,
+    util::span<const DERIVED> k,
+    util::span<point_t> p) {
+    assert(p.size() == k.size());
+    for(std::size_t i = 0; i < k.size(); ++i)
+      k[i].coordinates(range, p[i]);
+  }
+
   constexpr filling_curve(int_t value) : value_(value) {}
 
   // Max depth possible for this key
@@ -144,7 +327,7 @@ public:
     return value_;
   }
   // Convert this key to coordinates in range.
-  void coordinates(const std::array<point_t, 2> &, point_t &) {}
+  void coordinates(const std::array<point_t, 2> &, point_t &) const {}
   // Compute the range of a branch from its key
   // The space is recursively decomposed regarding the dimension
   std::array<point_t, 2> range(const std::array<point_t, 2> &) {
@@ -195,7 +378,6 @@ class hilbert_curve : public filling_curve<DIM, T, hilbert_curve<DIM, T>>
 
   using filling_curve<DIM, T, hilbert_curve>::value_;
   using filling_curve<DIM, T, hilbert_curve>::max_depth_;
-  using filling_curve<DIM, T, hilbert_curve>::bits_;
 
 public:
   constexpr hilbert_curve() : filling_curve<DIM, T, hilbert_curve>() {}
@@ -211,78 +393,19 @@ public:
   // otherwise the key will not be the same
   hilbert_curve(const std::array<point_t, 2> & range,
     const point_t & p,
-    const std::size_t depth) {
-    *this = filling_curve<DIM, T, hilbert_curve>::min();
-    assert(depth <= max_depth_);
-    std::array<int_t, dimension> coords;
-    const int_t max_val = (int_t(1) << (bits_ - 1) / dimension) - 1;
+    const std::size_t depth)
+    : hilbert_curve(key(base::interleave(base::quantize(range, p)), depth)) {}
 
-    // Convert the position to integer
-    for(Dimension i = 0; i < dimension; ++i) {
-      double min = range[0][i];
-      double scale = range[1][i] - min;
-      coords[i] = std::min(max_val,
-        static_cast<int_t>((p[i] - min) / scale * (int_t(1) << (max_depth_))));
-    }
-    // Handle 1D case
-    if(dimension == 1) {
-      assert(value_ & 1UL << max_depth_);
-      value_ |= coords[0] >> dimension;
-      value_ >>= (max_depth_ - depth);
-      return;
-    }
-    int_t mask = static_cast<int_t>(1) << (max_depth_);
-    for(int_t s = mask >> 1; s > 0; s >>= 1) {
-      std::array<int_t, dimension> bits;
-      for(Dimension j = 0; j < dimension; ++j) {
-        bits[j] = (s & coords[j]) > 0;
-      }
-      if(dimension == 2) {
-        value_ += s * s * ((3 * bits[0]) ^ bits[1]);
-        rotation2d(s, coords, bits);
-      }
-      if(dimension == 3) {
-        value_ += s * s * s * ((7 * bits[0]) ^ (3 * bits[1]) ^ bits[2]);
-        rotation3d(s, coords, bits);
-      }
-    }
-    // Then truncate the key to the depth
-    value_ >>= (max_depth_ - depth) * dimension;
-  }
-
-  void coordinates(const std::array<point_t, 2> & range, point_t & p) {
-    int_t key = value_;
-    std::array<int_t, dimension> coords;
-    coords.fill(int_t(0));
-
-    int_t n = int_t(1) << (max_depth_); // Number of cells to an edge.
-    for(int_t mask = int_t(1); mask < n; mask <<= 1) {
-      std::array<int_t, dimension> bits = {};
-      if(dimension == 3) {
-        bits[0] = (key & 4) > 0;
-        bits[1] = ((key & 2) ^ bits[0]) > 0;
-        bits[2] = ((key & 1) ^ bits[0] ^ bits[1]) > 0;
-        rotation3d(mask, coords, bits);
-        coords[0] += bits[0] * mask;
-        coords[1] += bits[1] * mask;
-        coords[2] += bits[2] * mask;
-      }
-      if(dimension == 2) {
-        bits[0] = (key & 2) > 0;
-        bits[1] = ((key & 1) ^ bits[0]) > 0;
-        rotation2d(mask, coords, bits);
-        coords[0] += bits[0] * mask;
-        coords[1] += bits[1] * mask;
-      }
-      key >>= dimension;
+  void coordinates(const std::array<point_t, 2> & range, point_t & p) const {
+    coord_t coords;
+    if constexpr(dimension == 1)
+      coords[0] = (value_ ^ base::min().value_) << 1;
+    else {
+      const auto & t = tables();
+      coords = base::deinterleave(walk(t.dec, t.dec2, value_));
     }
-    assert(key == int_t(1));
-    for(Dimension j = 0; j < dimension; ++j) {
-      double min = range[0][j];
-      double scale = range[1][j] - min;
-      p[j] =
-        min + scale * static_cast<double>(coords[j]) / (int_t(1) << max_depth_);
-    } // for
+    assert(value_ >> max_depth_ * dimension == int_t(1));
+    base::unquantize(range, coords, p);
   }
 
   std::array<point_t, 2> range(const std::array<point_t, 2> &) {
@@ -290,7 +413,135 @@ public:
   } // range
 
 private:
-  void rotation2d(const int_t & n,
+  using base = filling_curve<DIM, T, hilbert_curve>;
+  friend base;
+
+  static constexpr int_t digit_mask = (int_t(1) << dimension) - 1,
+                         pair_mask = (int_t(1) << 2 * dimension) - 1;
+
+  // The curve is a finite-state machine: each state is an orientation of the
+  // subcube at one level, and the coordinate bits at that level select both
+  // the key digit and the orientation of the next level.  The tables are
+  // derived from the rotations below.  Since each level depends on the
+  // previous one, the second set of tables, which consumes two levels per
+  // lookup, halves the length of that dependency chain.
+  struct step {
+    std::uint8_t out, next; // key digit(s) or coordinate bits; next state
+  };
+  struct lookup {
+    std::vector<std::array<step, 1 << dimension>> enc, dec;
+    std::vector<std::array<step, 1 << 2 * dimension>> enc2, dec2;
+  };
+
+  static const lookup & tables() {
+    static const lookup ret = [] {
+      // Transformed coordinate k is original coordinate p[k], complemented
+      // if bit k of f is set.
+      struct orientation {
+        std::array<std::uint8_t, dimension> p;
+        std::uint8_t f;
+        bool operator==(const orientation & o) const {
+          return p == o.p && f == o.f;
+        }
+      };
+      std::vector<orientation> states(1);
+      for(Dimension k = 0; k < dimension; ++k)
+        states[0].p[k] = k;
+      states[0].f = 0;
+
+      lookup ret;
+      for(std::size_t s = 0; s < states.size(); ++s) {
+        ret.enc.emplace_back();
+        ret.dec.emplace_back();
+        for(unsigned b = 0; b < 1u << dimension; ++b) {
+          const orientation o = states[s];
+          coord_t t;
+          for(Dimension k = 0; k < dimension; ++k)
+            t[k] = (b >> o.p[k] & 1) ^ (o.f >> k & 1);
+          unsigned digit;
+          // Rotate coordinates that record the axis they came from: k, or
+          // n-1-k if complemented.
+          constexpr int_t n = 8;
+          coord_t c;
+          for(Dimension k = 0; k < dimension; ++k)
+            c[k] = k;
+          if constexpr(dimension == 2) {
+            digit = (3 * t[0]) ^ t[1];
+            rotation2d(n, c, t);
+          }
+          else {
+            digit = (7 * t[0]) ^ (3 * t[1]) ^ t[2];
+            rotation3d(n, c, t);
+          }
+          orientation x{{}, 0};
+          for(Dimension k = 0; k < dimension; ++k) {
+            const bool flip = c[k] >= dimension;
+            const auto q = flip ? n - 1 - c[k] : c[k];
+            x.p[k] = o.p[q];
+            x.f |= ((o.f >> q & 1) ^ flip) << k;
+          }
+          const std::uint8_t i =
+            std::find(states.begin(), states.end(), x) - states.begin();
+          if(i == states.size())
+            states.push_back(x);
+          ret.enc[s][b] = {std::uint8_t(digit), i};
+          ret.dec[s][digit] = {std::uint8_t(b), i};
+        }
+      }
+      const auto pair = [](const auto & one, auto & two) {
+        two.resize(one.size());
+        for(std::size_t s = 0; s < one.size(); ++s)
+          for(unsigned b = 0; b < 1u << 2 * dimension; ++b) {
+            const step hi = one[s][b >> dimension],
+                       lo = one[hi.next][b & digit_mask];
+            two[s][b] = {std::uint8_t(hi.out << dimension | lo.out), lo.next};
+          }
+      };
+      pair(ret.enc, ret.enc2);
+      pair(ret.dec, ret.dec2);
+      return ret;
+    }();
+    return ret;
+  }
+
+  // Compute the key of depth \p depth from interleaved coordinates.
+  static int_t key(int_t m, std::size_t depth) {
+    assert(depth <= max_depth_);
+    int_t ret = base::min().value_;
+    if constexpr(dimension == 1) {
+      ret |= m >> dimension;
+      return ret >> (max_depth_ - depth);
+    }
+    else {
+      const auto & t = tables();
+      ret |= walk(t.enc, t.enc2, m);
+      return ret >> (max_depth_ - depth) * dimension;
+    }
+  }
+
+  // Run the state machine over the max_depth_ digits of \p x, from the most
+  // significant, using \p one for an odd first level and \p two thereafter.
+  template<class O, class W>
+  static int_t walk(const O & one, const W & two, int_t x) {
+    int_t ret = 0;
+    std::uint8_t state = 0;
+    std::size_t l = max_depth_;
+    if(l % 2) {
+      --l;
+      const auto e = one[state][x >> l * dimension & digit_mask];
+      ret |= int_t(e.out) << l * dimension;
+      state = e.next;
+    }
+    while(l) {
+      l -= 2;
+      const auto e = two[state][x >> l * dimension & pair_mask];
+      ret |= int_t(e.out) << l * dimension;
+      state = e.next;
+    }
+    return ret;
+  }
+
+  static void rotation2d(const int_t & n,
     std::array<int_t, dimension> & coords,
     const std::array<int_t, dimension> & bits) {
     if(bits[1] == 0) {
@@ -305,50 +556,57 @@ private:
     }
   }
 
-  void rotate_90_x(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_90_x(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = tmp[0];
     coords[1] = n - 1 - tmp[2];
     coords[2] = tmp[1];
   }
-  void rotate_90_y(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_90_y(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = tmp[2];
     coords[1] = tmp[1];
     coords[2] = n - 1 - tmp[0];
   }
-  void rotate_90_z(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_90_z(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = n - 1 - tmp[1];
     coords[1] = tmp[0];
     coords[2] = tmp[2];
   }
-  void rotate_180_x(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_180_x(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = tmp[0];
     coords[1] = n - 1 - tmp[1];
     coords[2] = n - 1 - tmp[2];
   }
-  void rotate_270_x(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_270_x(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = tmp[0];
     coords[1] = tmp[2];
     coords[2] = n - 1 - tmp[1];
   }
-  void rotate_270_y(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_270_y(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = n - 1 - tmp[2];
     coords[1] = tmp[1];
     coords[2] = tmp[0];
   }
-  void rotate_270_z(const int_t & n, std::array<int_t, dimension> & coords) {
+  static void rotate_270_z(const int_t & n,
+    std::array<int_t, dimension> & coords) {
     coord_t tmp = coords;
     coords[0] = tmp[1];
     coords[1] = n - 1 - tmp[0];
     coords[2] = tmp[2];
   }
 
-  void rotation3d(const int_t & n,
+  static void rotation3d(const int_t & n,
     std::array<int_t, dimension> & coords,
     const std::array<int_t, dimension> & bits) {
     if(!bits[0] && !bits[1] && !bits[2]) {
@@ -419,7 +677,6 @@ class morton_curve : public filling_curve<DIM, T, morton_curve<DIM, T>>
 
   using filling_curve<DIM, T, morton_curve>::value_;
   using filling_curve<DIM, T, morton_curve>::max_depth_;
-  using filling_curve<DIM, T, morton_curve>::bits_;
 
 public:
   constexpr morton_curve() : filling_curve<DIM, T, morton_curve>() {}
@@ -432,41 +689,12 @@ public:
   // Morton key can be generated directly up to the right depth
   morton_curve(const std::array<point_t, 2> & range,
     const point_t & p,
-    const std::size_t depth) {
-    *this = filling_curve<DIM, T, morton_curve>::min();
-    assert(depth <= max_depth_);
-    std::array<int_t, dimension> coords;
-    const int_t max_val = (int_t(1) << (bits_ - 1) / dimension) - 1;
-    for(Dimension i = 0; i < dimension; ++i) {
-      double min = range[0][i];
-      double scale = range[1][i] - min;
-      coords[i] = std::min(max_val,
-        static_cast<int_t>(
-          (p[i] - min) / scale *
-          static_cast<double>((int_t(1) << (bits_ - 1) / dimension))));
-    } // for
-    std::size_t k = 0;
-    for(std::size_t i = max_depth_ - depth; i < max_depth_; ++i) {
-      for(Dimension j = 0; j < dimension; ++j) {
-        int_t bit = (coords[j] & int_t(1) << i) >> i;
-        value_ |= bit << (k * dimension + j);
-      } // for
-      ++k;
-    } // for
-  } // morton_curve
+    const std::size_t depth)
+    : morton_curve(key(base::interleave(base::quantize(range, p)), depth)) {}
 
-  void coordinates(const std::array<point_t, 2> & range, point_t & p) {
-    std::array<int_t, dimension> coords;
-    coords.fill(int_t(0));
-    int_t id = value_;
-    std::size_t d = 0;
-    while(id >> dimension != int_t(0)) {
-      for(Dimension j = 0; j < dimension; ++j) {
-        coords[j] |= (((int_t(1) << j) & id) >> j) << d;
-      } // for
-      id >>= dimension;
-      ++d;
-    } // while
+  void coordinates(const std::array<point_t, 2> & range, point_t & p) const {
+    std::size_t d;
+    coord_t coords = split(d);
     constexpr int_t m = (int_t(1) << max_depth_) - 1;
     for(Dimension j = 0; j < dimension; ++j) {
       double min = range[0][j];
@@ -481,20 +709,9 @@ public:
     std::array<point_t, 2> result;
     result[0] = range[0];
     result[1] = range[1];
-    // Copy the key
-    int_t root = filling_curve<DIM, T, morton_curve>::root().value_;
     // Extract x,y and z
-    std::array<int_t, dimension> coords;
-    coords.fill(int_t(0));
-    int_t id = value_;
-    std::size_t d = 0;
-    while(id != root) {
-      for(Dimension j = 0; j < dimension; ++j) {
-        coords[j] |= (((int_t(1) << j) & id) >> j) << d;
-      }
-      id >>= dimension;
-      ++d;
-    }
+    std::size_t d;
+    const coord_t coords = split(d);
     for(Dimension i = 0; i < dimension; ++i) {
       // apply the reduction
       for(std::size_t j = d; j > 0; --j) {
@@ -509,6 +726,21 @@ public:
     } // for
     return result;
   } // range
+
+private:
+  using base = filling_curve<DIM, T, morton_curve>;
+  friend base;
+
+  // Compute the key of depth \p depth from interleaved coordinates.
+  static int_t key(int_t m, std::size_t depth) {
+    assert(depth <= max_depth_);
+    return base::min().value_ | m >> (max_depth_ - depth) * dimension;
+  }
+  // Get the coordinates encoded in this key and its depth.
+  coord_t split(std::size_t & d) const {
+    d = base::depth();
+    return base::deinterleave(value_ ^ int_t(1) << d * dimension);
+  }
 }; // class morton
 
 } // namespace flecsi
@@ -4,8 +4,12 @@
 #ifndef FLECSI_UTIL_GEOMETRY_KDTREE_HH
 #define FLECSI_UTIL_GEOMETRY_KDTREE_HH
 
+#include "flecsi/util/array_ref.hh"
 #include "flecsi/util/common.hh"
+#include "flecsi/util/crs.hh"
+#include "flecsi/util/geometry/filling_curve.hh"
 #include "flecsi/util/geometry/point.hh"
+#include "flecsi/util/pool.hh"
 
 #include <algorithm>
 #include <array>
@@ -13,7 +17,7 @@
 #include <iostream>
 #include <limits>
 #include <map>
-#include <stack>
+#include <numeric>
 #include <vector>
 
 namespace flecsi {
@@ -87,18 +91,32 @@ template<Dimension DIM>
 struct KDTree {
   // To store node info
   struct TNode {
-    int cur_root;
-    int imin;
-    int imax;
-    int icut;
+    long cur_root;
+    long imin;
+    long imax;
+    long first; // where to put the children (and then their descendants)
   };
 
   using point_t = util::point<double, DIM>;
   using boxes = std::vector<BBox<DIM>>;
-  KDTree(const boxes &);
+  // If a pool is given, independent subtrees are built concurrently.
+  KDTree(const boxes &, util::thread_pool * = nullptr);
+
+  // For each box in \p q, find the boxes in the tree that intersect it.
+  // Row \a i of \p out lists them in increasing order.
+  void query(util::span<const BBox<DIM>> q,
+    util::crs & out,
+    util::thread_pool * = nullptr) const;
+
+  // Call \p f with the index of each box in the tree that intersects \p b.
+  template<class F>
+  void query(const BBox<DIM> & b, F && f) const;
 
   boxes sbox;
   std::vector<long> linkp;
+
+private:
+  struct builder;
 };
 
 /****************************************************************************/
@@ -112,159 +130,216 @@ struct KDTree {
 /****************************************************************************/
 
 template<Dimension DIM>
-KDTree<DIM>::KDTree(const boxes & sboxp)
+struct KDTree<DIM>::builder {
+  KDTree & tree;
+  const boxes & sboxp;
+  std::vector<long> ipoly;
+  std::vector<point_t> bbc;
+
+  /* Partition the safety boxes of a node and fill in its two children,
+     calling f on each child that is not a leaf. */
+  template<class F>
+  void split(const TNode & node, F && f) {
+    auto & sbox = tree.sbox;
+    auto & linkp = tree.linkp;
+
+    /* Make this node point to its first child.  The adjacent location
+       is implicitly taken to be the location of the SECOND child of the
+       node.  A subtree with m safety boxes occupies 2m-1 locations, so the
+       descendants of the first child (which has imd-imn+1 boxes) are
+       followed directly by those of the second.  Subtrees therefore never
+       share locations and may be built in any order. */
+
+    linkp[node.cur_root] = node.first;
+    const long imn = node.imin;
+    const long imx = node.imax;
+    point_t cut_dim = sbox[node.cur_root].size();
+    const int icut = max_component(cut_dim);
+
+    /* Partition safety box subset associated with this node.
+       Using the appropriate cutting direction, reorder (ipoly) so that
+       the safety box with median bounding box center coordinate is
+       ipoly(imd), while the boxes {ipoly[i], i<imd} have SMALLER (or
+       equal) bounding box coordinates, and the boxes with
+       {ipoly[i], i>imd} have GREATER (or equal) bounding box
+       coordinates. */
+
+    const long imd = (imn + imx) / 2;
+    std::nth_element(ipoly.begin() + imn,
+      ipoly.begin() + imd,
+      ipoly.begin() + imx + 1,
+      [this, icut](const long i, const long j) {
+        return bbc[i][icut] < bbc[j][icut];
+      });
+
+    /* If a child's subset of safety boxes is a singleton, the child is a
+       leaf.  (Our convention is to set the link corresponding to a leaf
+       equal to the negative of the unique item contained in that leaf.)
+       Otherwise, compute the bounding box of the child to be the smallest
+       box containing all the associated safety boxes. */
+
+    const auto child = [&](long c, long lo, long hi, long first) {
+      sbox[c] = sboxp[ipoly[lo]];
+      if(lo == hi)
+        linkp[c] = -ipoly[lo];
+      else {
+        for(long i = lo + 1; i <= hi; i++)
+          sbox[c] += sboxp[ipoly[i]];
+        f(TNode{c, lo, hi, first});
+      }
+    };
+    child(node.first, imn, imd, node.first + 2);
+    child(node.first + 1, imd + 1, imx, node.first + 2 * (imd - imn + 1));
+  }
+
+  void build(const TNode & node) {
+    split(node, [this](const TNode & c) { build(c); });
+  }
+};
+
+template<Dimension DIM>
+KDTree<DIM>::KDTree(const boxes & sboxp, util::thread_pool * pool)
   : sbox(2 * sboxp.size()), linkp(2 * sboxp.size()) {
+  if(sboxp.empty())
+    return;
 
-  /* Compute the centers of the inputbounding boxes
+  /* Compute the centers of the input bounding boxes
    * and the root node of the k-D tree */
-  std::vector<point_t> bbc(sboxp.size());
-  int c = 0;
-  for(auto & b : sboxp) {
-    bbc[c++] = b.center();
-    sbox[0] += b;
+  builder b{*this, sboxp, std::vector<long>(sboxp.size()), {}};
+  b.bbc.reserve(sboxp.size());
+  sbox[0] = sboxp[0];
+  for(auto & x : sboxp) {
+    b.bbc.push_back(x.center());
+    sbox[0] += x;
   }
 
   /* If there is only one safety box, the root node is a leaf.
-     (Our convention is to set the link corresponding to a leaf
-     equal to the negative of the unique item contained in
-     that leaf.)  If the root is a leaf, our work is done. */
+     If the root is a leaf, our work is done. */
 
-  if(sboxp.size() == 1)
+  if(sboxp.size() == 1) {
     linkp[0] = 0;
-  else {
-
-    /* ipoly will contain a permutation of the integers
-       {0,...,sboxp.size()-1}. This permutation will be altered as we
-       create our balanced binary tree. nextp contains the
-       address of the next available node to be filled. */
-
-    std::vector<long> ipoly;
-    for(int i = 0; i < (int)sboxp.size(); i++) {
-      ipoly.push_back(i);
-    }
-
-    /* Use a stack to create the tree. Put the root node
-       ``0'' on the top of the stack of TNodes. The array
-       subset of ipoly (i.e., subset of boxes associated
-       with this node) is recorded using imin and imax in TNode.
-
-       We also record in the stack the appropriate ``cutting
-       direction'' for bisecting the set of safety boxes
-       corresponding to this node. This direction is either
-       the x, y, or z directions, depending on which dimension
-       of the bounding box is largest. */
-
-    point_t cut_dim = sbox[0].size();
-    std::stack<TNode> stk;
-    stk.push({0, 0, (int)sboxp.size() - 1, max_component(cut_dim)});
-
-    int nextp = 1;
-
-    /* Pop nodes off stack, create children nodes and put them
-       on stack. Continue until k-D tree has been created. */
-
-    while(!stk.empty()) {
-
-      /* Pop top node off stack. */
-      auto node = stk.top();
-      stk.pop();
-
-      /* Make this node point to next available node location (nextp).
-         This link represents the location of the FIRST CHILD
-         of the node. The adjacent location (nextp+1)
-         is implicitly taken to be the location of the SECOND
-         child of the node. */
-
-      linkp[node.cur_root] = nextp;
-      int imn = node.imin;
-      int imx = node.imax;
-      int icut = node.icut;
-
-      /* Partition safety box subset associated with this node.
-         Using the appropriate cutting direction, use SELECT to
-         reorder (ipoly) so that the safety box with median bounding
-         box center coordinate is ipoly(imd), while the
-         boxes {ipoly[i], i<imd} have SMALLER (or equal)
-         bounding box coordinates, and the boxes with
-         {ipoly[i], i>imd} have GREATER (or equal) bounding box
-         coordinates. */
-
-      int imd = (imn + imx) / 2;
-
-      // Select the median bounding box using std::nth_element.
-      auto comp = [&bbc, &icut](const long i, const long j) {
-        return bbc[i][icut] < bbc[j][icut];
-      };
-
-      std::nth_element(
-        ipoly.begin() + imn, ipoly.begin() + imd, ipoly.begin() + imx, comp);
-
-      /* If the first child's subset of safety boxes is a singleton,
-         the child is a leaf. Set the child's link to point to the
-         negative of the box number. Set the child's bounding
-         box to be equal to the safety box box. */
-
-      if(imn == imd) {
-        linkp[nextp] = -ipoly.at(imn);
-        sbox[nextp] = sboxp[ipoly.at(imn)];
-        nextp = nextp + 1;
-      }
-      else {
-
-        /* In this case, the subset of safety boxes corres to the
-           first child is more than one, and the child is
-           not a leaf. Compute the bounding box of this child to
-           be the smallest box containing all the associated safety'
-           boxes. */
-
-        sbox[nextp] = sboxp[ipoly.at(imn)];
-
-        for(int i = imn + 1; i <= imd; i++)
-          sbox[nextp] += sboxp[ipoly.at(i)];
+    return;
+  }
 
-        /* Put the first child onto the stack, noting the
-           associated element subset in imin and imax, and
-           putting the appropriate cutting direction in ict. */
+  /* ipoly will contain a permutation of the integers
+     {0,...,sboxp.size()-1}. This permutation will be altered as we
+     create our balanced binary tree.  The array subset of ipoly (i.e.,
+     subset of boxes associated with a node) is recorded using imin and
+     imax in TNode. */
+
+  std::iota(b.ipoly.begin(), b.ipoly.end(), 0);
+  const TNode root{0, 0, long(sboxp.size()) - 1, 1};
+  if(!pool) {
+    b.build(root);
+    return;
+  }
 
-        cut_dim = sbox[nextp].size();
-        stk.push({nextp, imn, imd, max_component(cut_dim)});
-        nextp++;
-      }
+  /* Split the top levels one level at a time, with the nodes of each
+     level in parallel, until there are enough subtrees to occupy the
+     pool; then build each subtree serially. */
+
+  std::vector<TNode> level{root}, next;
+  while(!level.empty() && level.size() < 256) {
+    next.assign(2 * level.size(), TNode{0, 0, 0, 0});
+    (*pool)(level.size(), [&](std::size_t i) {
+      TNode * out = &next[2 * i];
+      b.split(level[i], [&out](const TNode & c) { *out++ = c; });
+    });
+    // The root is never a child, so it marks an empty slot.
+    next.erase(std::remove_if(next.begin(),
+                 next.end(),
+                 [](const TNode & c) { return !c.cur_root; }),
+      next.end());
+    level.swap(next);
+  }
+  (*pool)(level.size(), [&](std::size_t i) { b.build(level[i]); });
+}
 
-      /* If the second child's subset of safety boxes is a singleton,
-         the child is a leaf. Set the child's link to point to the
-         negative of the sbox number. Set the child's bounding
-         box to be equal to that of the safety box. */
+template<Dimension DIM>
+template<class F>
+void
+KDTree<DIM>::query(const BBox<DIM> & b, F && f) const {
+  if(linkp.empty() || !sbox[0].intersects(b))
+    return;
+  // The tree is balanced, so its depth is at most about log2 of its size,
+  // and each level leaves at most one node on the stack.
+  std::array<long, 2 * std::numeric_limits<long>::digits> stk;
+  std::size_t top = 0;
+  stk[top++] = 0;
+  while(top) {
+    const long i = stk[--top], l = linkp[i];
+    if(l <= 0)
+      f(-l);
+    else
+      for(const long c : {l + 1, l})
+        if(sbox[c].intersects(b))
+          stk[top++] = c;
+  }
+}
 
-      if((imd + 1) == imx) {
-        linkp[nextp] = -ipoly.at(imx);
-        sbox[nextp] = sboxp[ipoly.at(imx)];
-        nextp = nextp + 1;
+template<Dimension DIM>
+void
+KDTree<DIM>::query(util::span<const BBox<DIM>> q,
+  util::crs & out,
+  util::thread_pool * pool) const {
+  const std::size_t n = q.size();
+  const auto each = [&](std::size_t m, auto && f) {
+    if(pool)
+      (*pool)(m, f);
+    else
+      for(std::size_t i = 0; i < m; ++i)
+        f(i);
+  };
+  // Queries are processed in chunks, each collecting its results separately.
+  constexpr std::size_t chunk = 1024;
+  const std::size_t nc = (n + chunk - 1) / chunk;
+
+  // Visit the queries in Morton order of their centers, so that consecutive
+  // queries traverse mostly the same (cached) nodes.
+  using key = morton_curve<DIM, std::uint64_t>;
+  std::vector<std::pair<std::uint64_t, std::size_t>> order(n);
+  if(n) {
+    std::array<point_t, 2> range{q[0].center(), q[0].center()};
+    for(auto & b : q) {
+      const point_t c = b.center();
+      for(Dimension d = 0; d < DIM; ++d) {
+        range[0][d] = std::min(range[0][d], c[d]);
+        range[1][d] = std::max(range[1][d], c[d]);
       }
-      else {
-
-        /* In this case, the subset of boxes corresponding to the
-           second child is more than one safety box, and the child is
-           not a leaf. Compute the bounding box of this child to
-           be the smallest box containing all the associated safety
-           boxes. */
-
-        sbox[nextp] = sboxp[ipoly.at(imd + 1)];
-
-        for(int i = imd + 2; i <= imx; i++)
-          sbox[nextp] += sboxp[ipoly.at(i)];
-
-        /* Put the second child onto the stack, noting the
-           associated element subset in imin and imax, and
-           putting the appropriate cutting direction in ict. */
+    }
+    for(Dimension d = 0; d < DIM; ++d)
+      if(range[1][d] == range[0][d])
+        range[1][d] += 1;
+    each(nc, [&](std::size_t c) {
+      for(std::size_t i = c * chunk, e = std::min(n, i + chunk); i < e; ++i)
+        order[i] = {key(range, q[i].center()).value(), i};
+    });
+    std::sort(order.begin(), order.end());
+  }
 
-        cut_dim = sbox[nextp].size();
-        stk.push({nextp, imd + 1, imx, max_component(cut_dim)});
-        nextp++;
-      }
+  util::offsets::storage end(n);
+  std::vector<std::size_t> at(n); // where each row starts in its chunk
+  std::vector<std::vector<util::gid>> found(nc);
+  each(nc, [&](std::size_t c) {
+    auto & v = found[c];
+    for(std::size_t o = c * chunk, e = std::min(n, o + chunk); o < e; ++o) {
+      const std::size_t i = order[o].second, b = v.size();
+      query(q[i], [&v](long j) { v.push_back(j); });
+      std::sort(v.begin() + b, v.end());
+      at[i] = b;
+      end[i] = v.size() - b;
+    }
+  });
+  std::partial_sum(end.begin(), end.end(), end.begin());
 
-    } /* End of the while loop */
-  }
+  std::vector<util::gid> values(n ? end.back() : 0);
+  each(nc, [&](std::size_t c) {
+    for(std::size_t o = c * chunk, e = std::min(n, o + chunk); o < e; ++o) {
+      const std::size_t i = order[o].second, b = i ? end[i - 1] : 0;
+      std::copy_n(found[c].begin() + at[i], end[i] - b, values.begin() + b);
+    }
+  });
+  out = util::crs(std::move(end), std::move(values));
 }
 
 using A2 = std::array<long, 2>;
@@ -300,47 +375,26 @@ template<Dimension DIM>
 void
 intersect(const KDTree<DIM> & k1,
   const KDTree<DIM> & k2,
-  int i1,
-  int i2,
+  long i1,
+  long i2,
   std::vector<A2> & candidates) {
-  std::vector<long> c1, c2;
   if(k1.sbox[i1].intersects(k2.sbox[i2])) {
-    // We don't want to test every leaf of one tree against some large
-    // safety box of the other tree that might intersect them even though
-    // most of its contents do not, so split both trees simultaneously.
     auto l1 = k1.linkp[i1];
     auto l2 = k2.linkp[i2];
 
-    if(l1 <= 0) { // box 1 is a leaf
-      if(l2 <= 0) {
-        candidates.push_back({-l1, -l2});
-        return; // so is box 2
-      }
-
-      // can't split the leaf
-      c1.push_back(i1);
-
-      // but split the other
-      c2.push_back(l2);
-      c2.push_back(l2 + 1);
-    }
-    else {
-      // split box 1
-      c1.push_back(l1);
-      c1.push_back(l1 + 1);
-
-      // and box 2 if possible
-      if(l2 <= 0) {
-        c2.push_back(i2);
-      }
-      else {
-        c2.push_back(l2);
-        c2.push_back(l2 + 1);
-      }
+    if(l1 <= 0 && l2 <= 0) { // both boxes are leaves
+      candidates.push_back({-l1, -l2});
+      return;
     }
 
-    for(auto & ii : c1) {
-      for(auto & jj : c2) {
+    // We don't want to test every leaf of one tree against some large
+    // safety box of the other tree that might intersect them even though
+    // most of its contents do not, so split both trees simultaneously
+    // (except that a leaf can't be split).
+    const long f1 = l1 <= 0 ? i1 : l1, n1 = l1 <= 0 ? 1 : 2;
+    const long f2 = l2 <= 0 ? i2 : l2, n2 = l2 <= 0 ? 1 : 2;
+    for(long ii = f1; ii < f1 + n1; ++ii) {
+      for(long jj = f2; jj < f2 + n2; ++jj) {
         intersect(k1, k2, ii, jj, candidates);
       }
     }
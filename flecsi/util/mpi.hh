@@ -6,6 +6,7 @@
 
 #include "flecsi/config.hh"
 #include "flecsi/util/array_ref.hh" // span
+#include "flecsi/util/profile.hh"
 #include "flecsi/util/serialize.hh"
 
 #include <algorithm>
@@ -13,6 +14,8 @@
 #include <cstddef> // byte
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -94,9 +97,11 @@ struct vector { // for *v functions
   template<class T>
   void put(const T & t) {
     const auto n = off.emplace_back(data.size());
-    data.resize(n + sz.emplace_back(serial::size(t)));
-    auto * p = data.data() + n;
-    serial::put(p, t);
+    {
+      serial::sink s(data);
+      serial::put(s, t);
+    }
+    sz.push_back(data.size() - n);
   }
 };
 } // namespace detail
@@ -148,6 +153,62 @@ struct comm {
     test(MPI_Comm_split(c0, c, k, &ret.c));
     return ret;
   }
+  // The processes that can share memory with this one, in the order of c0.
+  static comm shared(MPI_Comm c0) {
+    comm ret;
+    test(MPI_Comm_split_type(
+      c0, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &ret.c));
+    return ret;
+  }
+};
+
+// Memory to which each process in a communicator from comm::shared
+// contributes a segment that all of them can access.  Construction and
+// destruction are collective.
+struct shared_memory {
+  shared_memory(MPI_Comm c, std::size_t n) : n(n) {
+    // Let each segment be placed near its process.
+    MPI_Info info;
+    test(MPI_Info_create(&info));
+    test(MPI_Info_set(info, "alloc_shared_noncontig", "true"));
+    test(MPI_Win_allocate_shared(MPI_Aint(n), 1, info, c, &base, &w));
+    test(MPI_Info_free(&info));
+    test(MPI_Win_lock_all(MPI_MODE_NOCHECK, w));
+  }
+  shared_memory(shared_memory &&) = delete;
+  ~shared_memory() {
+    test(MPI_Win_unlock_all(w));
+    test(MPI_Win_free(&w));
+  }
+
+  // The size of each segment, in bytes.
+  std::size_t size() const {
+    return n;
+  }
+  // This process's segment.
+  std::byte * data() const {
+    return static_cast<std::byte *>(base);
+  }
+  // The segment of process r in the communicator.
+  const std::byte * segment(int r) const {
+    MPI_Aint s;
+    int u;
+    void * p;
+    test(MPI_Win_shared_query(w, r, &s, &u, &p));
+    return static_cast<const std::byte *>(p);
+  }
+
+  // Order the accesses to any segment before and after the call.  With a
+  // message from one process to another, this makes the stores made by the
+  // sender before it visible to the loads made by the receiver after it.
+  void sync() const {
+    test(MPI_Win_sync(w));
+  }
+
+private:
+  std::size_t n;
+  MPI_Win w;
+  void * base;
 };
 
 // NB: OpenMPI's predefined handles are not constant expressions.
@@ -290,6 +351,7 @@ struct future {
 
   T & operator()() & {
     this->req = {}; // this-> avoids Clang bug #62818
+    span.finish();
     return t;
   }
   T && operator()() && {
@@ -302,10 +364,15 @@ struct future {
   MPI_Request * request() {
     return req();
   }
+  // Profile the time until the value is first requested.
+  void measure(std::string_view region, std::string_view name) {
+    span.start(region, name);
+  }
 
 private:
   T t;
   auto_requests req;
+  profile::interval span;
 };
 
 /*!
@@ -683,6 +750,126 @@ all_to_allv(R && r, MPI_Comm comm = MPI_COMM_WORLD) {
   return result;
 } // all_to_allv
 
+namespace detail {
+// Messages larger than INT_MAX bytes are padded to a whole number of blocks.
+struct blocks {
+  static constexpr std::size_t size = 1 << 20;
+  static MPI_Datatype type() {
+    static const MPI_Datatype ret = [] {
+      MPI_Datatype ret;
+      test(MPI_Type_contiguous(size, MPI_BYTE, &ret));
+      datatypes.commit(ret);
+      return ret;
+    }();
+    return ret;
+  }
+};
+
+// A process can begin an exchange only after every process has begun the
+// previous one, so alternating between two pairs of tags keeps each exchange
+// from receiving the messages of the next.
+inline int
+sparse_tag(MPI_Comm comm) {
+  static const int key = [] {
+    int ret;
+    test(MPI_Comm_create_keyval(
+      MPI_COMM_NULL_COPY_FN, MPI_COMM_NULL_DELETE_FN, &ret, nullptr));
+    return ret;
+  }();
+  void * v;
+  int flag;
+  test(MPI_Comm_get_attr(comm, key, &v, &flag));
+  const auto n = flag ? reinterpret_cast<std::uintptr_t>(v) : 0;
+  test(MPI_Comm_set_attr(comm, key, reinterpret_cast<void *>(n + 1)));
+  return 27183 + 2 * int(n % 2);
+}
+} // namespace detail
+
+/*!
+  Sparse All-to-All (variable) communication pattern.
+
+  Each rank sends values only to the ranks it names, without knowing which
+  ranks will send to it.  The nonblocking consensus algorithm (NBX) is used,
+  so the cost depends on the number of messages rather than on the size of
+  the communicator.  Messages may exceed \c INT_MAX bytes.
+
+  \param r range of pairs of destination rank and value (\e e.g., a
+    \c std::map); each rank may appear at most once
+  \param comm An MPI communicator.
+
+  \return a \c std::map from source rank to the value sent by it (including
+    any sent to the current rank)
+ */
+
+template<typename R>
+auto
+sparse_all_to_allv(R && r, MPI_Comm comm = MPI_COMM_WORLD) {
+  using T = typename detail::value_type<R>::second_type;
+  // Tags not used by the other functions here:
+  const int tag = detail::sparse_tag(comm), big_tag = tag + 1;
+  const auto rank = mpi::rank(comm);
+
+  std::map<int, T> ret;
+  std::vector<std::vector<std::byte>> out;
+  auto_requests sends;
+  for(auto && [d, v] : r) {
+    if(int(d) == rank) {
+      ret.try_emplace(rank, v);
+      continue;
+    }
+    auto & m = out.emplace_back(serial::put_tuple<T>(v));
+    const bool big = m.size() > std::size_t(std::numeric_limits<int>::max());
+    if(big)
+      m.resize((m.size() + detail::blocks::size - 1) / detail::blocks::size *
+               detail::blocks::size);
+    // Synchronous sends are complete only when received, which is what
+    // allows the barrier to signal that all messages have arrived:
+    test(MPI_Issend(m.data(),
+      int(big ? m.size() / detail::blocks::size : m.size()),
+      big ? detail::blocks::type() : MPI_BYTE,
+      int(d),
+      big ? big_tag : tag,
+      comm,
+      sends()));
+  }
+
+  MPI_Request barrier = MPI_REQUEST_NULL;
+  for(bool sent = false;;) {
+    for(const bool big : {false, true}) {
+      int flag;
+      MPI_Message msg;
+      MPI_Status st;
+      test(MPI_Improbe(
+        MPI_ANY_SOURCE, big ? big_tag : tag, comm, &flag, &msg, &st));
+      if(flag) {
+        const auto t = big ? detail::blocks::type() : MPI_BYTE;
+        int n;
+        test(MPI_Get_count(&st, t, &n));
+        std::vector<std::byte> m(
+          std::size_t(n) * (big ? detail::blocks::size : 1));
+        test(MPI_Mrecv(m.data(), n, t, &msg, MPI_STATUS_IGNORE));
+        ret.try_emplace(st.MPI_SOURCE, serial::get1<T>(m.data()));
+      }
+    }
+    int done;
+    if(sent) {
+      test(MPI_Test(&barrier, &done, MPI_STATUS_IGNORE));
+      if(done)
+        break;
+    }
+    else {
+      test(MPI_Testall(
+        sends.v.size(), sends.v.data(), &done, MPI_STATUSES_IGNORE));
+      if(done) {
+        test(MPI_Ibarrier(comm, &barrier));
+        sent = true;
+      }
+    }
+  }
+
+  return ret;
+} // sparse_all_to_allv
+
 /*!
   All gather communication pattern implemented using MPI_Allgather. This
   function is convenient for passing more complicated types. Otherwise,
@@ -0,0 +1,117 @@
+// Copyright (C) 2016, Triad National Security, LLC
+// All rights reserved.
+
+#ifndef FLECSI_UTIL_POOL_HH
+#define FLECSI_UTIL_POOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace flecsi {
+namespace util {
+/// \addtogroup utils
+/// \{
+
+/// A fixed set of host threads that, together with the calling thread,
+/// execute a number of independent calls.
+struct thread_pool {
+  /// Start the threads.
+  /// \param n number of threads, including the calling thread
+  explicit thread_pool(unsigned n) {
+    for(; n > 1; --n)
+      workers_.emplace_back([this] { work(); });
+  }
+  thread_pool(thread_pool &&) = delete;
+  ~thread_pool() {
+    {
+      std::lock_guard l(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for(auto & t : workers_)
+      t.join();
+  }
+
+  /// Call \a f on each of [0,n) and return when all calls have completed.
+  /// The first exception thrown by any call is rethrown.
+  /// \param n number of calls
+  void operator()(std::size_t n, const std::function<void(std::size_t)> & f) {
+    {
+      std::lock_guard l(mutex_);
+      job_ = &f;
+      size_ = n;
+      next_ = 0;
+      ++generation_;
+    }
+    wake_.notify_all();
+    drain(f);
+    {
+      std::unique_lock l(mutex_);
+      idle_.wait(l, [this] { return !busy_; });
+      job_ = nullptr;
+    }
+    if(auto e = std::exchange(error_, nullptr))
+      std::rethrow_exception(e);
+  }
+
+private:
+  void drain(const std::function<void(std::size_t)> & f) {
+    for(std::size_t i; (i = next_++) < size_;) {
+      try {
+        f(i);
+      }
+      catch(...) {
+        std::lock_guard l(mutex_);
+        if(!error_)
+          error_ = std::current_exception();
+      }
+    }
+  }
+
+  void work() {
+    for(std::uint64_t seen = 0;;) {
+      const std::function<void(std::size_t)> * f;
+      {
+        std::unique_lock l(mutex_);
+        wake_.wait(l, [&] { return stop_ || generation_ != seen; });
+        if(stop_)
+          return;
+        seen = generation_;
+        // A late wakeup may find the job already finished.
+        if(!(f = job_))
+          continue;
+        ++busy_;
+      }
+      drain(*f);
+      {
+        std::lock_guard l(mutex_);
+        --busy_;
+      }
+      idle_.notify_one();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_, idle_;
+  const std::function<void(std::size_t)> * job_ = nullptr;
+  std::size_t size_ = 0;
+  std::atomic<std::size_t> next_{0};
+  std::uint64_t generation_ = 0;
+  unsigned busy_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+  std::vector<std::thread> workers_;
+}; // struct thread_pool
+
+/// \}
+} // namespace util
+} // namespace flecsi
+
+#endif
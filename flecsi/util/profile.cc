@@ -0,0 +1,138 @@
+#include "flecsi/util/profile.hh"
+#include "flecsi/flog.hh"
+#include "flecsi/util/mpi.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace flecsi {
+namespace util {
+namespace profile {
+
+namespace {
+// Write a JSON string literal.
+void
+quote(std::ostream & o, std::string_view s) {
+  o << '"';
+  for(const char c : s) {
+    if(c == '"' || c == '\\')
+      o << '\\' << c;
+    else if(static_cast<unsigned char>(c) < 0x20)
+      o << ' ';
+    else
+      o << c;
+  }
+  o << '"';
+}
+} // namespace
+
+void
+configure(const config & c) {
+  auto & s = detail::state::instance();
+  std::lock_guard l(s.mutex);
+  s.cfg = c;
+  s.logs.clear();
+  ++s.generation;
+  s.origin = detail::state::clock::now();
+  s.on = c.enabled();
+}
+
+std::map<std::string, totals>
+gather() {
+  auto & s = detail::state::instance();
+  std::map<std::string, totals> local;
+  {
+    std::lock_guard l(s.mutex);
+    for(auto & t : s.logs)
+      for(std::size_t i = 0; i < t->names.size(); ++i)
+        local[t->names[i]] += t->sums[i];
+  }
+  std::map<std::string, totals> ret;
+  for(auto & m : mpi::all_gatherv(local))
+    for(auto & [n, t] : m)
+      ret[n] += t;
+  return ret;
+}
+
+void
+write_trace(const std::string & file) {
+  auto & s = detail::state::instance();
+  const int rank = mpi::rank();
+  std::ostringstream os;
+  os << std::setprecision(3) << std::fixed;
+  {
+    std::lock_guard l(s.mutex);
+    for(auto & t : s.logs) {
+      const auto n = t->ring.size();
+      // Oldest retained event first.
+      for(auto i = t->recorded > n ? t->recorded - n : 0; i < t->recorded;
+          ++i) {
+        const auto & e = t->ring[i % n];
+        os << ",\n{\"name\":";
+        quote(os, t->names[e.name]);
+        os << ",\"ph\":\"X\",\"pid\":" << rank << ",\"tid\":" << t->id
+           << ",\"ts\":" << e.begin * 1e6
+           << ",\"dur\":" << (e.end - e.begin) * 1e6;
+        if(e.peers)
+          os << ",\"args\":{\"bytes\":" << e.bytes << ",\"peers\":" << e.peers
+             << '}';
+        os << '}';
+      }
+    }
+  }
+  const auto all = mpi::all_gatherv(std::move(os).str());
+  if(!rank) {
+    std::ofstream out(file);
+    out << "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\","
+           "\"pid\":0,\"args\":{\"name\":\"rank 0\"}}";
+    for(std::size_t r = 1; r < all.size(); ++r)
+      out << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << r
+          << ",\"args\":{\"name\":\"rank " << r << "\"}}";
+    for(auto & a : all)
+      out << a;
+    out << "\n]}\n";
+    flog_assert(out, "could not write profile trace to " << file);
+  }
+}
+
+void
+report() {
+  auto & s = detail::state::instance();
+  if(!s.on)
+    return;
+  s.on = false;
+
+  if(s.cfg.summary) {
+    const auto sums = gather();
+    if(!mpi::rank()) {
+      std::vector<std::pair<std::string, totals>> v(sums.begin(), sums.end());
+      std::stable_sort(v.begin(), v.end(), [](auto & a, auto & b) {
+        return a.second.time > b.second.time;
+      });
+      auto & o = std::cout;
+      const auto flags = o.flags();
+      o << "Profile (seconds, inclusive, all processes):\n"
+        << std::setw(10) << "calls" << std::setw(12) << "total"
+        << std::setw(12) << "mean" << std::setw(12) << "max"
+        << std::setw(14) << "bytes" << std::setw(10) << "messages"
+        << "  region\n"
+        << std::scientific << std::setprecision(3);
+      for(auto & [n, t] : v)
+        o << std::setw(10) << t.calls << std::setw(12) << t.time
+          << std::setw(12) << t.time / t.calls << std::setw(12) << t.max
+          << std::setw(14) << t.bytes << std::setw(10) << t.peers << "  " << n
+          << '\n';
+      o.flags(flags);
+      o << std::flush;
+    }
+  }
+  if(!s.cfg.trace.empty())
+    write_trace(s.cfg.trace);
+}
+
+} // namespace profile
+} // namespace util
+} // namespace flecsi
@@ -0,0 +1,240 @@
+// Copyright (C) 2016, Triad National Security, LLC
+// All rights reserved.
+
+#ifndef FLECSI_UTIL_PROFILE_HH
+#define FLECSI_UTIL_PROFILE_HH
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace flecsi {
+namespace util {
+namespace profile {
+/// \defgroup profile Built-in Profiler
+/// Timing of annotated regions without external tools.
+///
+/// When enabled (with the \c \--profile or \c \--profile-trace options),
+/// every \c annotation::rguard region is timed regardless of the Caliper
+/// configuration.  Each thread records into its own buffer: exact totals
+/// per region name and a ring buffer of the most recent events.  When the
+/// runtime finishes, the records are merged across processes into a
+/// summary table and/or a
+/// [Chrome trace](https://ui.perfetto.dev) file.
+///
+/// \ingroup utils
+/// \{
+
+/// Profiler settings.
+struct config {
+  bool summary = false; ///< Print a summary table when the runtime finishes.
+  std::string trace; ///< File for Chrome trace output, if not empty.
+  std::size_t buffer = 1 << 16; ///< Number of events retained per thread.
+
+  /// Whether any output is requested.
+  bool enabled() const {
+    return summary || !trace.empty();
+  }
+};
+
+/// Aggregate measurements for one region name.
+/// Times are inclusive of nested regions.
+struct totals {
+  std::uint64_t calls = 0; ///< Number of completed regions.
+  double time = 0; ///< Total seconds.
+  double max = 0; ///< Longest single region, in seconds.
+  std::uint64_t bytes = 0; ///< Bytes sent by copies within the region.
+  std::uint64_t peers = 0; ///< Messages sent by copies within the region.
+
+  totals & operator+=(const totals & t) {
+    calls += t.calls;
+    time += t.time;
+    max = std::max(max, t.max);
+    bytes += t.bytes;
+    peers += t.peers;
+    return *this;
+  }
+};
+
+namespace detail {
+struct event {
+  std::uint32_t name;
+  std::uint32_t peers;
+  std::uint64_t bytes;
+  double begin, end; // seconds since configuration
+};
+
+// The records of one thread.  Only that thread writes to it.
+struct thread_log {
+  thread_log(std::size_t n, unsigned id) : ring(n), id(id) {}
+
+  std::uint32_t intern(std::string_view region, std::string_view name) {
+    key.assign(region);
+    if(!name.empty())
+      (key += "->") += name;
+    const auto [i, fresh] = ids.try_emplace(key, std::uint32_t(names.size()));
+    if(fresh) {
+      names.push_back(key);
+      sums.emplace_back();
+    }
+    return i->second;
+  }
+
+  void push(const event & e) {
+    auto & s = sums[e.name];
+    ++s.calls;
+    const double t = e.end - e.begin;
+    s.time += t;
+    s.max = std::max(s.max, t);
+    s.bytes += e.bytes;
+    s.peers += e.peers;
+    if(!ring.empty())
+      ring[recorded % ring.size()] = e;
+    ++recorded;
+  }
+
+  std::vector<std::string> names;
+  std::map<std::string, std::uint32_t, std::less<>> ids;
+  std::vector<totals> sums; // indexed like names
+  std::vector<event> ring;
+  std::uint64_t recorded = 0;
+  std::vector<event> open; // unfinished regions, innermost last
+  unsigned id;
+
+private:
+  std::string key;
+};
+
+struct state {
+  static state & instance() {
+    static state s;
+    return s;
+  }
+
+  thread_log & log() {
+    thread_local thread_log * mine;
+    thread_local unsigned gen = 0;
+    if(const unsigned g = generation; gen != g) {
+      std::lock_guard l(mutex);
+      mine = logs
+               .emplace_back(std::make_unique<thread_log>(
+                 cfg.buffer, unsigned(logs.size())))
+               .get();
+      gen = g;
+    }
+    return *mine;
+  }
+
+  double now() const {
+    return std::chrono::duration<double>(clock::now() - origin).count();
+  }
+
+  using clock = std::chrono::steady_clock;
+
+  config cfg;
+  std::atomic<bool> on{false};
+  std::atomic<unsigned> generation{1}; // changed only when no regions are open
+  clock::time_point origin;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<thread_log>> logs;
+};
+} // namespace detail
+
+/// Return whether regions are being recorded.
+inline bool
+enabled() {
+  return detail::state::instance().on.load(std::memory_order_relaxed);
+}
+
+/// Discard all records and start recording according to \a c.
+/// Call only when no regions are open.
+void configure(const config & c);
+
+/// Start timing a region on the calling thread.
+/// \param region region type name
+/// \param name further name, such as that of a task
+inline void
+begin(std::string_view region, std::string_view name = {}) {
+  auto & s = detail::state::instance();
+  auto & l = s.log();
+  l.open.push_back({l.intern(region, name), 0, 0, s.now(), 0});
+}
+
+/// Finish the innermost region started by \c begin on the calling thread.
+inline void
+end() {
+  auto & s = detail::state::instance();
+  auto & l = s.log();
+  auto e = l.open.back();
+  l.open.pop_back();
+  e.end = s.now();
+  l.push(e);
+}
+
+/// Attribute communication to the innermost open region, if any.
+/// \param bytes number of bytes sent
+/// \param peers number of messages sent
+inline void
+traffic(std::uint64_t bytes, std::size_t peers) {
+  if(!enabled())
+    return;
+  auto & l = detail::state::instance().log();
+  if(!l.open.empty()) {
+    auto & e = l.open.back();
+    e.bytes += bytes;
+    e.peers += std::uint32_t(peers);
+  }
+}
+
+/// A region that may finish on a later call, such as the latency of a
+/// nonblocking collective.  It must finish on the thread that starts it.
+struct interval {
+  /// Start timing, if the profiler is enabled.
+  void start(std::string_view region, std::string_view name = {}) {
+    if(!enabled())
+      return;
+    auto & s = detail::state::instance();
+    log = &s.log();
+    e = {log->intern(region, name), 0, 0, s.now(), 0};
+  }
+  /// Record the interval if it was started and not already finished.
+  void finish() {
+    if(log) {
+      e.end = detail::state::instance().now();
+      std::exchange(log, nullptr)->push(e);
+    }
+  }
+
+private:
+  detail::thread_log * log = nullptr;
+  detail::event e;
+};
+
+/// Merge the totals from all threads and processes.
+/// \warning collective over \c MPI_COMM_WORLD
+std::map<std::string, totals> gather();
+
+/// Write a Chrome trace of the events retained on all processes.
+/// \param file output file name, used only on process 0
+/// \warning collective over \c MPI_COMM_WORLD
+void write_trace(const std::string & file);
+
+/// Produce the output requested by the configuration and stop recording.
+/// \warning collective over \c MPI_COMM_WORLD
+void report();
+
+/// \}
+} // namespace profile
+} // namespace util
+} // namespace flecsi
+
+#endif
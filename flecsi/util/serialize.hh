@@ -4,7 +4,9 @@
 #ifndef FLECSI_UTIL_SERIALIZE_HH
 #define FLECSI_UTIL_SERIALIZE_HH
 
+#include <algorithm> // max
 #include <cstddef>
+#include <cstdint>
 #include <cstring> // memcpy
 #include <map>
 #include <set>
@@ -14,11 +16,21 @@
 #include <utility> // declval
 #include <vector>
 
+#include "array_ref.hh"
 #include "type_traits.hh"
 #include <flecsi/flog.hh>
 
 namespace flecsi {
 namespace util {
+// Unfortunately, std::tuple<int> is not trivially copyable, so check more:
+template<class T>
+constexpr bool bit_assignable_v = std::is_trivially_copy_assignable_v<T> ||
+                                  (std::is_copy_assignable_v<T> &&
+                                    std::is_trivially_copy_constructible_v<T>);
+template<class T>
+constexpr bool bit_copyable_v =
+  std::is_default_constructible_v<T> && bit_assignable_v<T>;
+
 namespace serial {
 /// \defgroup serial Serialization
 /// Serialization without default constructibility.
@@ -44,8 +56,39 @@ mempcpy(std::size_t & x, const void *, std::size_t n) {
   x += n;
 }
 
+/// A growable buffer for serialization in a single pass.
+/// Pass it to \c put to append to the buffer, which is trimmed to the data
+/// written when the \c sink is destroyed.
+struct sink {
+  /// Append to a buffer.
+  explicit sink(std::vector<std::byte> & v) : v(v), n(v.size()) {}
+  sink(sink &&) = delete;
+  ~sink() {
+    v.resize(n);
+  }
+
+  /// Append space to be written directly.
+  /// \return the address of \a k new bytes
+  std::byte * extend(std::size_t k) {
+    if(n + k > v.size())
+      v.resize(std::max(2 * v.size(), n + k));
+    return v.data() + std::exchange(n, n + k);
+  }
+
+private:
+  std::vector<std::byte> & v;
+  std::size_t n; // bytes written
+};
+// For single-pass serialization (with amortized growth):
+inline void
+mempcpy(sink & s, const void * p, std::size_t n) {
+  std::memcpy(s.extend(n), p, n);
+}
+
 /// Extension point for serialization.
 /// The primary template is not really a complete type.
+/// Specializations should write only with \c mempcpy and \c put, so as to
+/// support every kind of output.
 /// \tparam T object type
 /// \tparam E unused SFINAE hook
 template<class T, class E = void>
@@ -63,8 +106,9 @@ struct traits
 ;
 
 /// Store objects and advance past their serialized form.
-/// \tparam P \c std::size_t for calculating sizes, or `std::byte*` for actual
-///   serialization
+/// \tparam P \c std::size_t for calculating sizes, `std::byte*` for actual
+///   serialization into a buffer of known size, or \c sink for serialization
+///   into a growing buffer
 /// \param p pointer or size
 /// \param tt objects
 template<class... TT, class P>
@@ -88,16 +132,15 @@ get(const std::byte *& p) {
 }
 
 /// Serialize into a buffer.
-/// \param f a function that accepts an argument for \c put
+/// \param f a function that accepts an argument for \c put, called once
 template<class F>
 std::vector<std::byte>
 buffer(F && f) {
-  std::size_t sz = 0;
-  f(sz);
-  std::vector<std::byte> ret(sz);
-  auto *const p0 = ret.data(), *p = p0;
-  std::forward<F>(f)(p);
-  flog_assert(p == p0 + sz, "Wrong serialization size");
+  std::vector<std::byte> ret;
+  {
+    sink s(ret);
+    std::forward<F>(f)(s);
+  }
   return ret;
 }
 
@@ -152,41 +195,69 @@ auto
 get_vector(const std::byte *& p) {
   auto n = get<S>(p);
   std::vector<T> ret;
-  ret.reserve(n);
-  while(n--)
-    ret.push_back(get<T>(p));
+  if constexpr(bit_copyable_v<T>) {
+    ret.resize(n);
+    std::memcpy(static_cast<void *>(ret.data()), p, n * sizeof(T));
+    p += n * sizeof(T);
+  }
+  else {
+    ret.reserve(n);
+    while(n--)
+      ret.push_back(get<T>(p));
+  }
+  return ret;
+}
+
+/// View the elements of a serialized \c std::vector without copying them.
+/// \tparam T bit-copyable element type
+/// \param p advanced past the vector; the buffer must outlive the view
+/// \warning The elements must be suitably aligned in the buffer, as they are
+///   if it is and everything serialized before them has a size that is a
+///   multiple of \c alignof(T).
+template<class T, class S = typename std::vector<T>::size_type>
+span<const T>
+get_span(const std::byte *& p) {
+  static_assert(bit_copyable_v<T>, "elements must be bit-copyable");
+  const auto n = get<S>(p);
+  flog_assert(reinterpret_cast<std::uintptr_t>(p) % alignof(T) == 0,
+    "serialized elements are misaligned");
+  const span<const T> ret(reinterpret_cast<const T *>(p), n);
+  p += n * sizeof(T);
   return ret;
 }
 
 namespace detail {
+// The serialized size of every T, or 0 if it varies.
+template<class T>
+constexpr std::size_t fixed_size = bit_copyable_v<T> ? sizeof(T) : 0;
+template<class T, class U>
+constexpr std::size_t fixed_size<std::pair<T, U>> =
+  bit_copyable_v<std::pair<T, U>> ? sizeof(std::pair<T, U>)
+  : fixed_size<std::remove_const_t<T>> && fixed_size<U>
+    ? fixed_size<std::remove_const_t<T>> + fixed_size<U>
+    : 0;
+
 template<class T>
 struct container {
   template<class P>
   static void put(P & p, const T & c) {
     serial::put(p, c.size());
-    for(auto & t : c)
-      serial::put(p, t);
+    constexpr auto n = fixed_size<typename T::value_type>;
+    if constexpr(n && std::is_same_v<P, std::size_t>)
+      p += c.size() * n;
+    else
+      for(auto & t : c)
+        serial::put(p, t);
   }
   static T get(const std::byte *& p) {
     T ret;
+    // The hint makes insertion constant-time for sorted containers:
     for(auto n = serial::get<typename T::size_type>(p); n--;)
-      ret.insert(serial::get<typename T::value_type>(p));
+      ret.insert(ret.end(), serial::get<typename T::value_type>(p));
     return ret;
   }
 };
 } // namespace detail
-} // namespace serial
-
-// Unfortunately, std::tuple<int> is not trivially copyable, so check more:
-template<class T>
-constexpr bool bit_assignable_v = std::is_trivially_copy_assignable_v<T> ||
-                                  (std::is_copy_assignable_v<T> &&
-                                    std::is_trivially_copy_constructible_v<T>);
-template<class T>
-constexpr bool bit_copyable_v =
-  std::is_default_constructible_v<T> && bit_assignable_v<T>;
-
-namespace serial {
 template<class T>
 struct traits<T, std::enable_if_t<bit_copyable_v<T>>> {
   static_assert(!std::is_pointer_v<T>, "Cannot serialize pointers");
@@ -232,7 +303,7 @@ struct traits<std::array<T, N>,
   using type = std::array<T, N>;
   template<class P>
   static void put(P & p, const type & a) {
-    for(auto e : a) {
+    for(auto & e : a) {
       serial::put(p, e);
     }
   }
@@ -251,6 +322,15 @@ public:
 template<class T>
 struct traits<std::vector<T>> : detail::container<std::vector<T>> {
   using type = std::vector<T>;
+  template<class P>
+  static void put(P & p, const type & v) {
+    if constexpr(bit_copyable_v<T>) {
+      serial::put(p, v.size());
+      mempcpy(p, v.data(), v.size() * sizeof(T));
+    }
+    else
+      detail::container<type>::put(p, v);
+  }
   static type get(const std::byte *& p) {
     return get_vector<T>(p);
   }
@@ -305,6 +385,8 @@ struct traits<T,
   static void put(P & p, const T & t) {
     if constexpr(std::is_pointer_v<P>)
       p += t.legion_serialize(p);
+    else if constexpr(std::is_same_v<P, sink>)
+      t.legion_serialize(p.extend(t.legion_buffer_size()));
     else
       p += t.legion_buffer_size();
   }
@@ -347,10 +429,10 @@ struct traits<T, decltype(void(convert<T>::put))> {
   using Convert = convert_traits<T>;
   template<class P>
   static void put(P & p, const T & t) {
-    if constexpr(std::is_pointer_v<P>)
-      serial::put(p, Convert::put(t));
-    else
+    if constexpr(std::is_same_v<P, std::size_t>)
       p += Convert::size(t);
+    else
+      serial::put(p, Convert::put(t));
   }
   static T get(const std::byte *& p) {
     return Convert::get(
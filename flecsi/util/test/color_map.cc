@@ -49,6 +49,21 @@ interface() {
 
     EXPECT_EQ(
       util::mpi::one_to_alli([](int r) { return single{r}; }, 0).r, process());
+
+    // Each process sends to itself and to the next, but not to the last.
+    // Consecutive exchanges must not receive each other's messages.
+    for(int i = 0; i < 4; ++i) {
+      const int p = process(), n = processes();
+      std::map<int, std::vector<int>> send{{p, {p}}};
+      if(p + 1 < n)
+        send[p + 1].assign(p + 1, p + i);
+      const auto recv = util::mpi::sparse_all_to_allv(send);
+      ASSERT_EQ(recv.size(), p ? 2u : 1u);
+      EXPECT_EQ(recv.at(p), std::vector<int>{p});
+      if(p) {
+        EXPECT_EQ(recv.at(p - 1), std::vector<int>(p, p - 1 + i));
+      }
+    }
   };
 }
 
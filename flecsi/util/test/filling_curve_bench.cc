@@ -0,0 +1,174 @@
+// Compare table-driven and batch key encoding with bitwise encoding.
+
+#include "flecsi/runtime.hh"
+#include "flecsi/util/geometry/filling_curve.hh"
+#include "flecsi/util/unit.hh"
+#include "flecsi/util/unit/bench.hh"
+
+#include <random>
+#include <vector>
+
+using namespace flecsi;
+using util::unit::best;
+
+flecsi::program_option<int> count(util::unit::bench_options,
+  "count,n",
+  "Number of points to encode.",
+  {{flecsi::option_default, 1 << 14}});
+
+constexpr Dimension dimension = 3;
+using int_t = std::uint64_t;
+using point_t = util::point<double, dimension>;
+using range_t = std::array<point_t, 2>;
+using coord_t = std::array<int_t, dimension>;
+using morton = morton_curve<dimension, int_t>;
+using hilbert = hilbert_curve<dimension, int_t>;
+
+// The encoders as they were: one bit (Morton) or one level with branching
+// rotations (Hilbert) at a time.
+namespace legacy {
+constexpr std::size_t max_depth = (sizeof(int_t) * 8 - 1) / dimension;
+
+coord_t
+quantize(const range_t & range, const point_t & p) {
+  coord_t ret;
+  const int_t max_val = (int_t(1) << max_depth) - 1;
+  for(Dimension i = 0; i < dimension; ++i) {
+    double min = range[0][i];
+    double scale = range[1][i] - min;
+    ret[i] = std::min(max_val,
+      static_cast<int_t>(
+        (p[i] - min) / scale * static_cast<double>(int_t(1) << max_depth)));
+  }
+  return ret;
+}
+
+int_t
+morton(const range_t & range, const point_t & p) {
+  const auto coords = quantize(range, p);
+  int_t ret = int_t(1) << max_depth * dimension;
+  for(std::size_t i = 0; i < max_depth; ++i) {
+    for(Dimension j = 0; j < dimension; ++j) {
+      int_t bit = (coords[j] & int_t(1) << i) >> i;
+      ret |= bit << (i * dimension + j);
+    }
+  }
+  return ret;
+}
+
+void
+rotate_90_y(int_t n, coord_t & c) {
+  c = {c[2], c[1], n - 1 - c[0]};
+}
+void
+rotate_90_z(int_t n, coord_t & c) {
+  c = {n - 1 - c[1], c[0], c[2]};
+}
+void
+rotate_180_x(int_t n, coord_t & c) {
+  c = {c[0], n - 1 - c[1], n - 1 - c[2]};
+}
+void
+rotate_270_x(int_t n, coord_t & c) {
+  c = {c[0], c[2], n - 1 - c[1]};
+}
+void
+rotate_270_y(int_t n, coord_t & c) {
+  c = {n - 1 - c[2], c[1], c[0]};
+}
+void
+rotate_270_z(int_t n, coord_t & c) {
+  c = {c[1], n - 1 - c[0], c[2]};
+}
+
+void
+rotation3d(int_t n, coord_t & c, const coord_t & b) {
+  if(!b[0] && !b[1] && !b[2]) {
+    rotate_270_z(n, c);
+    rotate_270_x(n, c);
+  }
+  else if(!b[0] && b[2]) {
+    rotate_90_z(n, c);
+    rotate_90_y(n, c);
+  }
+  else if(b[1] && !b[2]) {
+    rotate_180_x(n, c);
+  }
+  else if(b[0] && b[2]) {
+    rotate_270_z(n, c);
+    rotate_270_y(n, c);
+  }
+  else if(b[0] && !b[2] && !b[1]) {
+    rotate_90_y(n, c);
+    rotate_90_z(n, c);
+  }
+}
+
+int_t
+hilbert(const range_t & range, const point_t & p) {
+  auto coords = quantize(range, p);
+  int_t ret = int_t(1) << max_depth * dimension;
+  for(int_t s = int_t(1) << (max_depth - 1); s > 0; s >>= 1) {
+    coord_t bits;
+    for(Dimension j = 0; j < dimension; ++j)
+      bits[j] = (s & coords[j]) > 0;
+    ret += s * s * s * ((7 * bits[0]) ^ (3 * bits[1]) ^ bits[2]);
+    rotation3d(s, coords, bits);
+  }
+  return ret;
+}
+} // namespace legacy
+
+template<class K, class L>
+int
+compare(const range_t & range,
+  const std::vector<point_t> & pts,
+  L && legacy,
+  const char * name) {
+  UNIT() {
+    const std::size_t n = pts.size();
+    std::vector<int_t> old(n);
+    std::vector<K> keys(n), batch(n);
+
+    const double t0 = best([&] {
+      for(std::size_t i = 0; i < n; ++i)
+        old[i] = legacy(range, pts[i]);
+    });
+    const double t1 = best([&] {
+      for(std::size_t i = 0; i < n; ++i)
+        keys[i] = K(range, pts[i]);
+    });
+    const double t2 = best([&] { K::encode(range, pts, batch); });
+    for(std::size_t i = 0; i < n; ++i) {
+      ASSERT_EQ(keys[i].value(), old[i]);
+      ASSERT_EQ(batch[i].value(), old[i]);
+    }
+
+    std::vector<point_t> inv(n);
+    const double t3 = best([&] { K::decode(range, batch, inv); });
+    EXPECT_LT(distance(inv[0], pts[0]), 1e-5);
+
+    const double m = n / 1e6;
+    flog(info) << name << ": encode bitwise " << m / t0 << " Mkeys/s, each "
+               << m / t1 << " Mkeys/s, batch " << m / t2
+               << " Mkeys/s; decode " << m / t3 << " Mkeys/s" << std::endl;
+  };
+}
+
+int
+filling_curve_bench() {
+  UNIT() {
+    const range_t range{point_t{-1, -1, -1}, point_t{1, 2, 3}};
+    std::vector<point_t> pts(count.value());
+    std::mt19937_64 gen(42);
+    for(auto & p : pts)
+      for(Dimension j = 0; j < dimension; ++j)
+        p[j] = std::uniform_real_distribution<double>(
+          range[0][j], range[1][j])(gen);
+
+    EXPECT_EQ(compare<morton>(range, pts, legacy::morton, "Morton"), 0);
+    EXPECT_EQ(compare<hilbert>(range, pts, legacy::hilbert, "Hilbert"), 0);
+  };
+} // filling_curve_bench
+
+util::unit::driver<filling_curve_bench> driver;
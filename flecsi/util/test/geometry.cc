@@ -3,6 +3,8 @@
 #include "flecsi/util/geometry/point.hh"
 #include "flecsi/util/unit.hh"
 
+#include <vector>
+
 using namespace flecsi;
 
 // Point Tests
@@ -170,9 +172,9 @@ hilbert_3d_rnd() {
       hcs[i] = hc(range, points[i]);
       point_t inv;
       hcs[i].coordinates(range, inv);
-      // double dist = distance(points[i], inv);
+      double dist = distance(points[i], inv);
       flog(info) << points[i] << " " << hcs[i] << " = " << inv << std::endl;
-      // ASSERT_TRUE(dist < 1.0e-3);
+      ASSERT_TRUE(dist < 1.0e-3);
     }
 
     // rnd
@@ -183,9 +185,19 @@ hilbert_3d_rnd() {
       point_t inv;
       hc h(range, pt);
       h.coordinates(range, inv);
-      // double dist = distance(pt, inv);
+      double dist = distance(pt, inv);
       flog(info) << pt << " = " << h << " = " << inv << std::endl;
-      // ASSERT_TRUE(dist < 1.0e-4);
+      ASSERT_TRUE(dist < 1.0e-4);
+    }
+
+    // batch
+    std::vector<hc> keys(points.size());
+    hc::encode(range, points, keys);
+    std::array<point_t, 8> inv;
+    hc::decode(range, keys, inv);
+    for(std::size_t i = 0; i < points.size(); ++i) {
+      ASSERT_EQ(keys[i], hcs[i]);
+      ASSERT_TRUE(distance(points[i], inv[i]) < 1.0e-3);
     }
   };
 } // hilbert_3d_rnd
@@ -302,6 +314,16 @@ morton_3d_rnd() {
       flog(info) << pt << " = " << h << " = " << inv << std::endl;
       ASSERT_TRUE(dist < 1.0e-4);
     }
+
+    // batch
+    std::vector<mc> keys(points.size());
+    mc::encode(range, points, keys);
+    std::array<point_t, 8> inv;
+    mc::decode(range, keys, inv);
+    for(std::size_t i = 0; i < points.size(); ++i) {
+      ASSERT_EQ(keys[i], mcs[i]);
+      ASSERT_TRUE(distance(points[i], inv[i]) < 1.0e-4);
+    }
   };
 } // morton_3d_rnd
 
@@ -361,6 +383,15 @@ kdtree() {
       for(int i = 0; i < ntrg * ntrg; ++i)
         EXPECT_EQ(s(candidates_map[i]), ref_candidates[i]);
 
+      // query all the target boxes at once
+      util::crs found;
+      src_tree.query(trg_boxes, found);
+      ASSERT_EQ(found.size(), trg_boxes.size());
+      for(int i = 0; i < ntrg * ntrg; ++i) {
+        EXPECT_TRUE(std::is_sorted(found[i].begin(), found[i].end()));
+        EXPECT_EQ(s(found[i]), ref_candidates[i]);
+      }
+
       // list the candidates
       std::cout << "Candidates Map :\n";
       for(auto & cells : candidates_map) {
@@ -434,6 +465,16 @@ kdtree() {
       for(int i = 0; i < ntrg * ntrg * ntrg; ++i) {
         EXPECT_EQ(s(candidates_map[i]), ref(i));
       }
+
+      // build and query with threads
+      util::thread_pool pool(3);
+      util::KDTree<3> pooled(src_boxes, &pool);
+      EXPECT_EQ(pooled.linkp, src_tree.linkp);
+      util::crs found;
+      pooled.query(trg_boxes, found, &pool);
+      for(int i = 0; i < ntrg * ntrg * ntrg; ++i) {
+        EXPECT_EQ(s(found[i]), ref(i));
+      }
     }
   };
 } // kdtree
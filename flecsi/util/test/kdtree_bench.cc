@@ -0,0 +1,90 @@
+// Compare serial and threaded k-d tree construction and queries.
+
+#include "flecsi/runtime.hh"
+#include "flecsi/util/geometry/kdtree.hh"
+#include "flecsi/util/unit.hh"
+#include "flecsi/util/unit/bench.hh"
+
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace flecsi;
+using util::unit::best;
+
+flecsi::program_option<int> count(util::unit::bench_options,
+  "count,n",
+  "Number of boxes in each set.",
+  {{flecsi::option_default, 10000}});
+flecsi::program_option<int> pool_threads(util::unit::bench_options,
+  "threads,t",
+  "Number of threads for the threaded trials.",
+  {{flecsi::option_default, 4}});
+
+constexpr Dimension dimension = 3;
+using box = util::BBox<dimension>;
+using tree = util::KDTree<dimension>;
+
+// Boxes about as large as the spacing between their random centers, so that
+// each overlaps a handful of others.
+std::vector<box>
+random_boxes(std::size_t n, std::mt19937_64 & gen) {
+  const double h = std::cbrt(1.0 / n);
+  std::uniform_real_distribution<double> pos(0, 1), size(h / 4, h);
+  std::vector<box> ret(n);
+  for(auto & b : ret)
+    for(Dimension d = 0; d < dimension; ++d) {
+      const double c = pos(gen), s = size(gen) / 2;
+      b.lower[d] = c - s;
+      b.upper[d] = c + s;
+    }
+  return ret;
+}
+
+int
+kdtree_bench() {
+  UNIT() {
+    std::mt19937_64 gen(42);
+    const auto src = random_boxes(count.value(), gen),
+               trg = random_boxes(count.value(), gen);
+    util::thread_pool pool(pool_threads.value());
+
+    std::optional<tree> serial, pooled;
+    const double t0 = best([&] { serial.emplace(src); });
+    const double t1 = best([&] { pooled.emplace(src, &pool); });
+    ASSERT_EQ(pooled->linkp, serial->linkp);
+
+    // The pairwise traversal of two trees, for reference.
+    std::vector<util::A2> pairs;
+    const double t2 = best([&] {
+      const tree t(trg);
+      pairs.clear();
+      util::intersect(*serial, t, pairs);
+    });
+
+    util::crs found, threaded;
+    const double t3 = best([&] { serial->query(trg, found); });
+    const double t4 = best([&] { serial->query(trg, threaded, &pool); });
+    ASSERT_EQ(found.offsets.ends(), threaded.offsets.ends());
+    ASSERT_EQ(found.values, threaded.values);
+
+    std::sort(pairs.begin(), pairs.end(), [](auto & a, auto & b) {
+      return a[1] < b[1] || (a[1] == b[1] && a[0] < b[0]);
+    });
+    ASSERT_EQ(pairs.size(), found.values.size());
+    for(std::size_t i = 0; i < pairs.size(); ++i)
+      ASSERT_EQ(util::gid(pairs[i][0]), found.values[i]);
+
+    const double m = count.value() / 1e6;
+    flog(info) << count.value() << " boxes, " << pairs.size()
+               << " intersections: build " << m / t0 << " Mboxes/s, with "
+               << pool_threads.value() << " threads " << m / t1
+               << " Mboxes/s; tree-tree intersect " << m / t2
+               << " Mboxes/s; query " << m / t3 << " Mboxes/s, with "
+               << pool_threads.value() << " threads " << m / t4 << " Mboxes/s"
+               << std::endl;
+  };
+} // kdtree_bench
+
+util::unit::driver<kdtree_bench> driver;
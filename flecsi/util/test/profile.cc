@@ -0,0 +1,60 @@
+#include "flecsi/util/annotation.hh"
+#include "flecsi/util/profile.hh"
+#include "flecsi/util/unit.hh"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+using namespace flecsi;
+
+void
+wait() {
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+int
+one() {
+  return 1;
+}
+
+int
+profile_driver() {
+  UNIT() {
+    namespace prof = util::profile;
+    ASSERT_TRUE(prof::enabled());
+    const auto size = processes();
+
+    execute<wait, mpi>();
+    EXPECT_EQ((reduce<one, exec::fold::sum, mpi>().get()), int(size));
+    {
+      util::annotation::rguard<util::annotation::execute_task_copy_engine> g;
+      prof::traffic(100, 2);
+    }
+
+    const auto sums = prof::gather();
+    const auto & user = sums.at(util::annotation::execute_task_user::name +
+                                "->" + util::symbol<wait>());
+    EXPECT_EQ(user.calls, size);
+    EXPECT_GE(user.time, 0.01 * size);
+    EXPECT_GE(user.max, 0.01);
+#if FLECSI_BACKEND == FLECSI_BACKEND_mpi
+    EXPECT_EQ(
+      sums.at("execute_task->reduction->" + util::symbol<one>()).calls, size);
+#endif
+    const auto & copy =
+      sums.at(util::annotation::execute_task_copy_engine::name);
+    EXPECT_EQ(copy.bytes, 100 * size);
+    EXPECT_EQ(copy.peers, 2 * size);
+
+    prof::write_trace("profile-test.json");
+    if(!process()) {
+      std::ifstream in("profile-test.json");
+      std::string line;
+      std::getline(in, line);
+      EXPECT_EQ(line, "{\"traceEvents\":[");
+    }
+  };
+} // profile_driver
+
+util::unit::driver<profile_driver> driver;
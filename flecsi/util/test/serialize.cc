@@ -2,6 +2,7 @@
 #include "flecsi/run/context.hh"
 #include "flecsi/util/unit.hh"
 
+#include <algorithm>
 #include <limits>
 
 using namespace flecsi::util;
@@ -244,3 +245,42 @@ simple_context() {
 } // simple_context
 
 unit::driver<simple_context> simple_context_driver;
+
+//----------------------------------------------------------------------------//
+// Bulk copies and views.
+//----------------------------------------------------------------------------//
+
+int
+bulk() {
+  UNIT() {
+    const std::vector<std::vector<int>> vv{{1, 2, 3}, {}, {4}};
+    const std::map<int, double> m{{1, 0.5}, {2, 1.5}};
+    const std::vector<std::size_t> vs{7, 8, 9};
+
+    // Element sizes, not sizeof(std::pair<int, double>):
+    EXPECT_EQ(serial::size(m),
+      sizeof(std::size_t) + m.size() * (sizeof(int) + sizeof(double)));
+    EXPECT_EQ(serial::size(vv), 4 * sizeof(std::size_t) + 4 * sizeof(int));
+
+    const auto data = serial::put_tuple(vs, vv, m);
+    ASSERT_EQ(data.size(), serial::size(vs, vv, m));
+    {
+      std::vector<std::byte> fixed(data.size());
+      auto * p = fixed.data();
+      serial::put(p, vs, vv, m);
+      EXPECT_TRUE(fixed == data);
+    }
+
+    const auto * p = data.data();
+    const auto s = serial::get_span<std::size_t>(p);
+    ASSERT_EQ(s.size(), vs.size());
+    EXPECT_EQ(static_cast<const void *>(s.data()),
+      static_cast<const void *>(data.data() + sizeof(std::size_t)));
+    EXPECT_TRUE(std::equal(s.begin(), s.end(), vs.begin()));
+    EXPECT_EQ(serial::get<std::vector<std::vector<int>>>(p), vv);
+    EXPECT_EQ((serial::get<std::map<int, double>>(p)), m);
+    EXPECT_EQ(p, data.data() + data.size());
+  };
+} // bulk
+
+unit::driver<bulk> bulk_driver;
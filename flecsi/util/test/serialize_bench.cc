@@ -0,0 +1,139 @@
+// Compare single-pass, bulk serialization with elementwise serialization.
+
+#include "flecsi/runtime.hh"
+#include "flecsi/util/serialize.hh"
+#include "flecsi/util/unit.hh"
+#include "flecsi/util/unit/bench.hh"
+
+#include <map>
+#include <vector>
+
+using namespace flecsi;
+using util::unit::best;
+using namespace flecsi::util;
+
+flecsi::program_option<int> count(util::unit::bench_options,
+  "count,n",
+  "Number of rows in each payload.",
+  {{flecsi::option_default, 2000}});
+
+// Two passes (to size and then to write) that visit every element, as the
+// serialization traits once did.
+namespace legacy {
+template<class P, class T>
+void put(P &, const T &);
+template<class P, class T>
+void put(P &, const std::vector<T> &);
+template<class P, class K, class V>
+void put(P &, const std::map<K, V> &);
+
+template<class P, class T>
+void
+put(P & p, const T & t) {
+  serial::put(p, t);
+}
+template<class P, class T>
+void
+put(P & p, const std::vector<T> & v) {
+  serial::put(p, v.size());
+  for(auto & t : v)
+    legacy::put(p, t);
+}
+template<class P, class K, class V>
+void
+put(P & p, const std::map<K, V> & m) {
+  serial::put(p, m.size());
+  for(auto & [k, v] : m) {
+    legacy::put(p, k);
+    legacy::put(p, v);
+  }
+}
+
+template<class T>
+std::vector<std::byte>
+buffer(const T & t) {
+  std::size_t n = 0;
+  legacy::put(n, t);
+  std::vector<std::byte> ret(n);
+  auto * p = ret.data();
+  legacy::put(p, t);
+  return ret;
+}
+
+template<class T>
+struct reader {
+  static T get(const std::byte *& p) {
+    return serial::get<T>(p);
+  }
+};
+template<class T>
+struct reader<std::vector<T>> {
+  static std::vector<T> get(const std::byte *& p) {
+    auto n = serial::get<std::size_t>(p);
+    std::vector<T> ret;
+    ret.reserve(n);
+    while(n--)
+      ret.push_back(reader<T>::get(p));
+    return ret;
+  }
+};
+template<class K, class V>
+struct reader<std::map<K, V>> {
+  static std::map<K, V> get(const std::byte *& p) {
+    std::map<K, V> ret;
+    for(auto n = serial::get<std::size_t>(p); n--;) {
+      auto k = reader<K>::get(p);
+      ret.emplace(std::move(k), reader<V>::get(p));
+    }
+    return ret;
+  }
+};
+} // namespace legacy
+
+template<class T>
+int
+compare(const T & t, const char * name) {
+  UNIT() {
+    const auto data = serial::put_tuple(t);
+    ASSERT_TRUE(data == legacy::buffer(t));
+    ASSERT_EQ(serial::get1<T>(data.data()), t);
+
+    std::size_t sink = 0; // keep the work from being optimized away
+    const double put0 = best([&] { sink += legacy::buffer(t).size(); });
+    const double put1 = best([&] { sink += serial::put_tuple(t).size(); });
+    const double get0 = best([&] {
+      const auto * p = data.data();
+      sink += legacy::reader<T>::get(p).size();
+    });
+    const double get1 =
+      best([&] { sink += serial::get1<T>(data.data()).size(); });
+    EXPECT_GT(sink, 0u);
+
+    const double mb = data.size() / 1e6;
+    flog(info) << name << " (" << mb << " MB): put elementwise " << mb / put0
+               << " MB/s, bulk " << mb / put1 << " MB/s; get elementwise "
+               << mb / get0 << " MB/s, bulk " << mb / get1 << " MB/s"
+               << std::endl;
+  };
+}
+
+int
+serialize_bench() {
+  UNIT() {
+    const std::size_t n = count.value();
+    std::vector<std::vector<int>> rows(n);
+    std::map<std::size_t, std::vector<double>> map;
+    std::vector<std::size_t> flat;
+    for(std::size_t i = 0; i < n; ++i) {
+      rows[i].assign(i % 64, int(i));
+      map[i * 3].assign(i % 16, i / 2.0);
+      flat.insert(flat.end(), 8, i);
+    }
+
+    EXPECT_EQ(compare(rows, "vector<vector<int>>"), 0);
+    EXPECT_EQ(compare(map, "map<size_t, vector<double>>"), 0);
+    EXPECT_EQ(compare(flat, "vector<size_t>"), 0);
+  };
+} // serialize_bench
+
+util::unit::driver<serialize_bench> driver;
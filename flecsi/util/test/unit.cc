@@ -54,6 +54,50 @@ log_driver() {
         "2],\n 4:\n [0, 1, 2],\n 5:\n [0, 1, 2],\n 6:\n [0, 1, 2],\n 7:\n [0, "
         "1, 2],\n 8:\n [0, 1, 2],\n 9:\n [0, 1, 2]}");
     }
+
+#if defined(FLECSI_ENABLE_FLOG)
+    {
+      // Deferred formatting matches formatting immediately.
+      flog::packet_t p;
+      const int i = -3;
+      const std::string str = "string";
+      p.put(i);
+      p.put(0.1);
+      p.put("literal");
+      p.put(str.c_str());
+      p.put(str);
+      p.put('c');
+      p.put(true);
+      p.put(std::size_t(7));
+      p.put(static_cast<const void *>(&i));
+      p.text("\n");
+      p.finish("!");
+
+      std::ostringstream o;
+      o << i << 0.1 << "literal" << str.c_str() << str << 'c' << true
+        << std::size_t(7) << static_cast<const void *>(&i) << "!\n";
+      EXPECT_EQ(p.message(), o.str());
+    }
+#endif
+
+#if defined(FLOG_ENABLE_MPI)
+    {
+      // Other pointers are formatted immediately: a stream buffer is read.
+      static_assert(!flog::packet_t::deferred<std::streambuf *>);
+      static_assert(!flog::packet_t::deferred<const int *>);
+      std::stringstream ss;
+      ss << "streamed from a buffer";
+      flog(info) << ss.rdbuf() << std::endl;
+
+      auto & s = flog::state::instance();
+      flog::state::log_size(s);
+      bool found = false;
+      for(const auto & p : s.packets())
+        if(p.message().find("streamed from a buffer") != std::string::npos)
+          found = true;
+      EXPECT_TRUE(found);
+    }
+#endif
   };
 } // flog
 
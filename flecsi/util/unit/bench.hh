@@ -0,0 +1,52 @@
+// Copyright (C) 2016, Triad National Security, LLC
+// All rights reserved.
+
+#ifndef FLECSI_UTIL_UNIT_BENCH_HH
+#define FLECSI_UTIL_UNIT_BENCH_HH
+
+#include "flecsi/run/options.hh"
+
+#include <chrono>
+#include <type_traits>
+
+namespace flecsi::util::unit {
+/// \addtogroup unit
+/// \{
+
+/// Option group for benchmark parameters.
+inline constexpr const char * bench_options = "Benchmark Options";
+
+/// Number of timed trials, of which the best is reported.
+inline program_option<int> repeat(bench_options,
+  "repeat,r",
+  "Number of timed trials (the best is reported).",
+  {{option_default, 1}});
+
+/// Return the best time in seconds over \c repeat trials.
+/// \param f callable that either performs one trial or returns the time
+///   taken by one
+template<class F>
+double
+best(F && f) {
+  double ret = 0;
+  for(int i = 0; i < repeat.value(); ++i) {
+    double t;
+    if constexpr(std::is_void_v<std::invoke_result_t<F &>>) {
+      const auto start = std::chrono::steady_clock::now();
+      f();
+      t =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+    }
+    else
+      t = f();
+    if(!i || t < ret)
+      ret = t;
+  }
+  return ret;
+}
+
+/// \}
+} // namespace flecsi::util::unit
+
+#endif